@@ -1,5 +1,3 @@
-
-
 # In this file we are doing all of our 'configure' checks. Things like checking
 # for headers, functions, libraries, types and size of types.
 INCLUDE (${CMAKE_ROOT}/Modules/CheckIncludeFile.cmake)
@@ -9,6 +7,187 @@ INCLUDE (${CMAKE_ROOT}/Modules/CheckCXXSourceCompiles.cmake)
 INCLUDE (${CMAKE_ROOT}/Modules/TestBigEndian.cmake)
 INCLUDE (${CMAKE_ROOT}/Modules/CheckSymbolExists.cmake)
 
+#-----------------------------------------------------------------------------
+# The results of the checks below only depend on the compiler, its flags and
+# the target platform. They are stored in a file keyed by exactly those inputs
+# inside CMP_CONFIGURE_CACHE_DIR so that a fresh build directory that uses the
+# same tool chain does not need to spawn a single compiler for them.
+#-----------------------------------------------------------------------------
+if(NOT DEFINED CMP_CONFIGURE_CACHE_DIR)
+  set(_cmp_default_cache_dir "")
+  if(NOT "$ENV{XDG_CACHE_HOME}" STREQUAL "")
+    set(_cmp_default_cache_dir "$ENV{XDG_CACHE_HOME}/cmp")
+  elseif(WIN32 AND NOT "$ENV{LOCALAPPDATA}" STREQUAL "")
+    set(_cmp_default_cache_dir "$ENV{LOCALAPPDATA}/cmp")
+  elseif(NOT "$ENV{HOME}" STREQUAL "")
+    set(_cmp_default_cache_dir "$ENV{HOME}/.cache/cmp")
+  endif()
+  file(TO_CMAKE_PATH "${_cmp_default_cache_dir}" _cmp_default_cache_dir)
+endif()
+set(CMP_CONFIGURE_CACHE_DIR "${_cmp_default_cache_dir}" CACHE PATH
+    "Directory where CMP shares its configure check results between build directories. Leave empty to disable.")
+mark_as_advanced(CMP_CONFIGURE_CACHE_DIR)
+
+set(CMP_CONFIGURE_CACHE_FILE "")
+set(CMP_CONFIGURE_CACHE_LOADED FALSE)
+if(NOT "${CMP_CONFIGURE_CACHE_DIR}" STREQUAL "")
+  set(_cmp_cache_key_inputs "")
+  foreach(_cmp_var CMAKE_SYSTEM_NAME CMAKE_SYSTEM_VERSION CMAKE_SYSTEM_PROCESSOR CMAKE_SYSROOT
+                   CMAKE_OSX_ARCHITECTURES CMAKE_OSX_DEPLOYMENT_TARGET CMAKE_OSX_SYSROOT CMAKE_TOOLCHAIN_FILE
+                   CMAKE_C_COMPILER CMAKE_C_COMPILER_ID CMAKE_C_COMPILER_VERSION CMAKE_C_FLAGS
+                   CMAKE_CXX_COMPILER CMAKE_CXX_COMPILER_ID CMAKE_CXX_COMPILER_VERSION CMAKE_CXX_FLAGS
+                   CMAKE_BUILD_TYPE CMAKE_REQUIRED_FLAGS CMAKE_REQUIRED_DEFINITIONS CMAKE_REQUIRED_INCLUDES
+                   CMAKE_REQUIRED_LIBRARIES CMAKE_SIZEOF_VOID_P)
+    string(APPEND _cmp_cache_key_inputs "${_cmp_var}=${${_cmp_var}}\n")
+  endforeach()
+  # Changing any of the probes themselves must invalidate the cache as well
+  foreach(_cmp_probe cmpConfigureChecks.cmake cmpBatchedChecks.cxx.in TestBoolType.cxx TestCharSignedness.cxx
+                     TestCompareTypes.cxx GetTimeOfDayTest.cpp TestMiscFeatures.c)
+    file(MD5 "${CMP_CORE_TESTS_SOURCE_DIR}/${_cmp_probe}" _cmp_probe_md5)
+    string(APPEND _cmp_cache_key_inputs "${_cmp_probe}=${_cmp_probe_md5}\n")
+  endforeach()
+  string(SHA1 _cmp_cache_key "${_cmp_cache_key_inputs}")
+  set(CMP_CONFIGURE_CACHE_FILE "${CMP_CONFIGURE_CACHE_DIR}/ConfigureChecks-${_cmp_cache_key}.cmake")
+
+  if(EXISTS "${CMP_CONFIGURE_CACHE_FILE}")
+    include("${CMP_CONFIGURE_CACHE_FILE}")
+    set(CMP_CONFIGURE_CACHE_LOADED TRUE)
+    message(STATUS "Using cached CMP configure checks from ${CMP_CONFIGURE_CACHE_FILE}")
+  endif()
+endif()
+
+#-----------------------------------------------------------------------------
+# Compiles a single program that answers every header, type size and type
+# property question at once. Each answer is stored in the same cache variable
+# that the individual CHECK_INCLUDE_FILE/CHECK_TYPE_SIZE/TRY_COMPILE calls
+# further down use, which makes those calls skip their own compile. If the
+# batched program does not compile the variables stay undefined and the
+# individual checks run as they always did.
+#   HEADERS - pairs of "header;variable"
+#   TYPES   - pairs of "type;variable"
+#-----------------------------------------------------------------------------
+function(cmpBatchedConfigureChecks)
+  set(options)
+  set(oneValueArgs)
+  set(multiValueArgs HEADERS TYPES)
+  cmake_parse_arguments(Z "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
+
+  set(CMP_BATCHED_HEADER_PROBES "")
+  set(CMP_BATCHED_HEADER_REQUIRES "")
+  set(CMP_BATCHED_TYPE_PROBES "")
+  set(CMP_BATCHED_TYPE_REQUIRES "")
+  set(probe_keys "")
+  set(probe_vars "")
+  set(need_probe FALSE)
+
+  list(LENGTH Z_HEADERS num_items)
+  set(index 0)
+  while(index LESS num_items)
+    list(GET Z_HEADERS ${index} header)
+    math(EXPR next "${index} + 1")
+    list(GET Z_HEADERS ${next} var)
+    if(NOT DEFINED ${var})
+      set(need_probe TRUE)
+    endif()
+    math(EXPR id "${index} / 2")
+    string(APPEND CMP_BATCHED_HEADER_PROBES "#if __has_include(<${header}>)\nchar cmp_probe_h${id}[] = \"INFO:h${id}[1]\";\n#else\nchar cmp_probe_h${id}[] = \"INFO:h${id}[0]\";\n#endif\n")
+    string(APPEND CMP_BATCHED_HEADER_REQUIRES "  require += cmp_probe_h${id}[argc];\n")
+    list(APPEND probe_keys "h${id}")
+    list(APPEND probe_vars "${var}")
+    math(EXPR index "${index} + 2")
+  endwhile()
+
+  list(LENGTH Z_TYPES num_items)
+  set(index 0)
+  while(index LESS num_items)
+    list(GET Z_TYPES ${index} type)
+    math(EXPR next "${index} + 1")
+    list(GET Z_TYPES ${next} var)
+    if(NOT DEFINED HAVE_${var})
+      set(need_probe TRUE)
+    endif()
+    math(EXPR id "${index} / 2")
+    string(REGEX REPLACE "(.)" "'\\1', " id_chars "${id}")
+    string(APPEND CMP_BATCHED_TYPE_PROBES "char cmp_probe_s${id}[] = {'I', 'N', 'F', 'O', ':', 's', ${id_chars}'[', CMP_SIZE_DIGITS(${type}), ']', '\\0'}; /* ${type} */\n")
+    string(APPEND CMP_BATCHED_TYPE_REQUIRES "  require += cmp_probe_s${id}[argc];\n")
+    list(APPEND probe_keys "s${id}")
+    list(APPEND probe_vars "${var}")
+    math(EXPR index "${index} + 2")
+  endwhile()
+
+  if(NOT DEFINED CMP_COMPILER_HAS_BOOL OR NOT DEFINED CMP_TYPE_CHAR_IS_SIGNED)
+    set(need_probe TRUE)
+  endif()
+  if(NOT need_probe)
+    return()
+  endif()
+
+  set(probe_dir ${PROJECT_BINARY_DIR}/CMakeTmp/Batched)
+  set(probe_bin ${PROJECT_BINARY_DIR}/CMakeFiles/cmpBatchedChecks.bin)
+  configure_file(${CMP_CORE_TESTS_SOURCE_DIR}/cmpBatchedChecks.cxx.in ${probe_dir}/cmpBatchedChecks.cxx @ONLY)
+  message(STATUS "Checking headers, type sizes and type properties (batched)")
+  file(REMOVE ${probe_bin})
+  TRY_COMPILE(CMP_BATCHED_CHECKS_COMPILED
+              ${probe_dir}
+              ${probe_dir}/cmpBatchedChecks.cxx
+              COPY_FILE ${probe_bin}
+              OUTPUT_VARIABLE OUTPUT)
+  if(NOT CMP_BATCHED_CHECKS_COMPILED OR NOT EXISTS ${probe_bin})
+    message(STATUS "Checking headers, type sizes and type properties (batched) -- failed, checking one at a time")
+    file(APPEND ${CMAKE_BINARY_DIR}/CMakeFiles/CMakeError.log
+      "Batched CMP configure checks failed with the following output:\n${OUTPUT}\n")
+    return()
+  endif()
+
+  file(STRINGS ${probe_bin} info_strings LIMIT_COUNT 1000 REGEX "INFO:[a-z][0-9]+\\[[0-9]+\\]")
+  set(conflicts "")
+  foreach(info ${info_strings})
+    if("${info}" MATCHES "INFO:([a-z][0-9]+)\\[([0-9]+)\\]")
+      set(key ${CMAKE_MATCH_1})
+      math(EXPR value "${CMAKE_MATCH_2}")
+      # Universal binaries may report different values per architecture
+      if(DEFINED result_${key} AND NOT "${result_${key}}" STREQUAL "${value}")
+        list(APPEND conflicts ${key})
+      endif()
+      set(result_${key} ${value})
+    endif()
+  endforeach()
+
+  list(LENGTH probe_keys num_probes)
+  set(index 0)
+  while(index LESS num_probes)
+    list(GET probe_keys ${index} key)
+    list(GET probe_vars ${index} var)
+    math(EXPR index "${index} + 1")
+    list(FIND conflicts ${key} conflict)
+    if(NOT DEFINED result_${key} OR NOT conflict EQUAL -1)
+      continue()
+    endif()
+    if("${key}" MATCHES "^h")
+      if(NOT DEFINED ${var})
+        if(result_${key})
+          set(${var} 1 CACHE INTERNAL "Have include ${var}")
+        else()
+          set(${var} "" CACHE INTERNAL "Have include ${var}")
+        endif()
+      endif()
+    elseif(NOT DEFINED HAVE_${var})
+      set(HAVE_${var} TRUE CACHE INTERNAL "Result of TRY_COMPILE")
+      set(${var} ${result_${key}} CACHE INTERNAL "CHECK_TYPE_SIZE: sizeof(${var})")
+    endif()
+  endwhile()
+
+  if(NOT DEFINED CMP_COMPILER_HAS_BOOL AND "${result_b0}" STREQUAL "1")
+    SET(CMP_COMPILER_HAS_BOOL 1 CACHE INTERNAL "Support for C++ type bool")
+  endif()
+  if(NOT DEFINED CMP_TYPE_CHAR_IS_SIGNED AND DEFINED result_c0)
+    list(FIND conflicts c0 conflict)
+    if(conflict EQUAL -1)
+      SET(CMP_TYPE_CHAR_IS_SIGNED ${result_c0} CACHE INTERNAL "Whether char is signed.")
+    endif()
+  endif()
+  message(STATUS "Checking headers, type sizes and type properties (batched) -- done")
+endfunction()
 
 TEST_BIG_ENDIAN(CMP_WORDS_BIGENDIAN)
 
@@ -19,24 +198,77 @@ macro (CORE_CHECK_INCLUDE_FILE header var prefix)
     CHECK_INCLUDE_FILE("${header}"        ${prefix}_${var} )
 endmacro()
 
+set(CMP_CORE_HEADERS
+  "stddef.h"        HAVE_STDDEF_H
+  "stdint.h"        HAVE_STDINT_H
+  "stdlib.h"        HAVE_STDLIB_H
+  "setjmp.h"        HAVE_SETJMP_H
+  "string.h"        HAVE_STRING_H
+  "stdio.h"         HAVE_STDIO_H
+  "math.h"          HAVE_MATH_H
+  "time.h"          HAVE_TIME_H
+  "sys/time.h"      HAVE_SYS_TIME_H
+  "sys/types.h"     HAVE_SYS_TYPES_H
+  "sys/socket.h"    HAVE_SYS_SOCKET_H
+  "sys/stat.h"      HAVE_SYS_STAT_H
+  "netinet/in.h"    HAVE_NETINET_IN_H
+  "arpa/inet.h"     HAVE_ARPA_INET_H
+  "unistd.h"        HAVE_UNISTD_H
+  "fcntl.h"         HAVE_FCNTL_H
+  "errno.h"         HAVE_ERRNO_H
+)
+
+# The types that exist everywhere are checked in the batch. Optional types
+# such as __int64 and off64_t are left to CHECK_TYPE_SIZE since a missing type
+# would make the whole batched program fail to compile.
+set(CMP_CORE_TYPES
+  char           CMP_SIZEOF_CHAR
+  short          CMP_SIZEOF_SHORT
+  int            CMP_SIZEOF_INT
+  unsigned       CMP_SIZEOF_UNSIGNED
+  "long long"    CMP_SIZEOF_LONG_LONG
+  float          CMP_SIZEOF_FLOAT
+  double         CMP_SIZEOF_DOUBLE
+  "long double"  CMP_SIZEOF_LONG_DOUBLE
+  int8_t         CMP_SIZEOF_INT8_T
+  uint8_t        CMP_SIZEOF_UINT8_T
+  int16_t        CMP_SIZEOF_INT16_T
+  uint16_t       CMP_SIZEOF_UINT16_T
+  int32_t        CMP_SIZEOF_INT32_T
+  uint32_t       CMP_SIZEOF_UINT32_T
+  int64_t        CMP_SIZEOF_INT64_T
+  uint64_t       CMP_SIZEOF_UINT64_T
+  off_t          CMP_SIZEOF_OFF_T
+)
+if(NOT APPLE)
+  list(APPEND CMP_CORE_TYPES long CMP_SIZEOF_LONG size_t CMP_SIZEOF_SIZE_T)
+  if(NOT WIN32)
+    list(APPEND CMP_CORE_TYPES ssize_t CMP_SIZEOF_SSIZE_T)
+  endif()
+endif()
+
+set(_cmp_batched_headers "")
+list(LENGTH CMP_CORE_HEADERS _cmp_num_items)
+set(_cmp_index 0)
+while(_cmp_index LESS _cmp_num_items)
+  list(GET CMP_CORE_HEADERS ${_cmp_index} _cmp_header)
+  math(EXPR _cmp_index "${_cmp_index} + 1")
+  list(GET CMP_CORE_HEADERS ${_cmp_index} _cmp_var)
+  math(EXPR _cmp_index "${_cmp_index} + 1")
+  list(APPEND _cmp_batched_headers "${_cmp_header}" CMP_${_cmp_var})
+endwhile()
+
+cmpBatchedConfigureChecks(HEADERS ${_cmp_batched_headers} TYPES ${CMP_CORE_TYPES})
 
-CORE_CHECK_INCLUDE_FILE("stddef.h"        HAVE_STDDEF_H   CMP)
-CORE_CHECK_INCLUDE_FILE("stdint.h"        HAVE_STDINT_H   CMP)
-CORE_CHECK_INCLUDE_FILE("stdlib.h"        HAVE_STDLIB_H   CMP)
-CORE_CHECK_INCLUDE_FILE("setjmp.h"        HAVE_SETJMP_H   CMP)
-CORE_CHECK_INCLUDE_FILE("string.h"        HAVE_STRING_H   CMP)
-CORE_CHECK_INCLUDE_FILE("stdio.h"         HAVE_STDIO_H   CMP)
-CORE_CHECK_INCLUDE_FILE("math.h"          HAVE_MATH_H   CMP)
-CORE_CHECK_INCLUDE_FILE("time.h"          HAVE_TIME_H   CMP)
-CORE_CHECK_INCLUDE_FILE("sys/time.h"      HAVE_SYS_TIME_H   CMP)
-CORE_CHECK_INCLUDE_FILE("sys/types.h"     HAVE_SYS_TYPES_H   CMP)
-CORE_CHECK_INCLUDE_FILE("sys/socket.h"    HAVE_SYS_SOCKET_H   CMP)
-CORE_CHECK_INCLUDE_FILE("sys/stat.h"      HAVE_SYS_STAT_H   CMP)
-CORE_CHECK_INCLUDE_FILE("netinet/in.h"    HAVE_NETINET_IN_H   CMP)
-CORE_CHECK_INCLUDE_FILE("arpa/inet.h"     HAVE_ARPA_INET_H   CMP)
-CORE_CHECK_INCLUDE_FILE("unistd.h"        HAVE_UNISTD_H   CMP)
-CORE_CHECK_INCLUDE_FILE("fcntl.h"         HAVE_FCNTL_H   CMP)
-CORE_CHECK_INCLUDE_FILE("errno.h"         HAVE_ERRNO_H   CMP)
+list(LENGTH CMP_CORE_HEADERS _cmp_num_items)
+set(_cmp_index 0)
+while(_cmp_index LESS _cmp_num_items)
+  list(GET CMP_CORE_HEADERS ${_cmp_index} _cmp_header)
+  math(EXPR _cmp_index "${_cmp_index} + 1")
+  list(GET CMP_CORE_HEADERS ${_cmp_index} _cmp_var)
+  math(EXPR _cmp_index "${_cmp_index} + 1")
+  CORE_CHECK_INCLUDE_FILE("${_cmp_header}" ${_cmp_var} CMP)
+endwhile()
 
 if(WIN32)
   if(NOT UNIX)
@@ -234,21 +466,25 @@ if(MSVC)
 endif()
 
 if(NOT MSVC)
-    TRY_COMPILE(CMP_HAVE_TIME_GETTIMEOFDAY
-          ${CMAKE_BINARY_DIR}
-          ${CMP_CORE_TESTS_SOURCE_DIR}/GetTimeOfDayTest.cpp
-          COMPILE_DEFINITIONS -DTRY_TIME_H
-          OUTPUT_VARIABLE OUTPUT)
+    if(NOT DEFINED CMP_HAVE_TIME_GETTIMEOFDAY)
+      TRY_COMPILE(CMP_HAVE_TIME_GETTIMEOFDAY
+            ${CMAKE_BINARY_DIR}
+            ${CMP_CORE_TESTS_SOURCE_DIR}/GetTimeOfDayTest.cpp
+            COMPILE_DEFINITIONS -DTRY_TIME_H
+            OUTPUT_VARIABLE OUTPUT)
+    endif()
     if(CMP_HAVE_TIME_GETTIMEOFDAY STREQUAL "TRUE")
         set(CMP_HAVE_TIME_GETTIMEOFDAY "1")
         set(VERSION_COMPILE_FLAGS "-DCMP_HAVE_TIME_GETTIMEOFDAY")
     endif(CMP_HAVE_TIME_GETTIMEOFDAY STREQUAL "TRUE")
 
-    TRY_COMPILE(CMP_HAVE_SYS_TIME_GETTIMEOFDAY
-          ${CMAKE_BINARY_DIR}
-          ${CMP_CORE_TESTS_SOURCE_DIR}/GetTimeOfDayTest.cpp
-          COMPILE_DEFINITIONS -DTRY_SYS_TIME_H
-          OUTPUT_VARIABLE OUTPUT)
+    if(NOT DEFINED CMP_HAVE_SYS_TIME_GETTIMEOFDAY)
+      TRY_COMPILE(CMP_HAVE_SYS_TIME_GETTIMEOFDAY
+            ${CMAKE_BINARY_DIR}
+            ${CMP_CORE_TESTS_SOURCE_DIR}/GetTimeOfDayTest.cpp
+            COMPILE_DEFINITIONS -DTRY_SYS_TIME_H
+            OUTPUT_VARIABLE OUTPUT)
+    endif()
     if(CMP_HAVE_SYS_TIME_GETTIMEOFDAY STREQUAL "TRUE")
         set(CMP_HAVE_SYS_TIME_GETTIMEOFDAY "1")
         set(VERSION_COMPILE_FLAGS "-DCMP_HAVE_SYS_TIME_GETTIMEOFDAY")
@@ -271,28 +507,30 @@ SET(CMP_CMP_PRINTF_LL_WIDTH "CMP_PRINTF_LL_WIDTH")
 if(CMP_PRINTF_LL_WIDTH MATCHES "^CMP_PRINTF_LL_WIDTH$")
   SET(PRINT_LL_FOUND 0)
   MESSAGE(STATUS "Checking for appropriate format for 64 bit long:")
-  FOREACH(CMP_PRINTF_LL l64 l L q I64 ll)
-    SET(CURRENT_TEST_DEFINITIONS "-DPRINTF_LL_WIDTH=${CMP_PRINTF_LL}")
-    if(CMP_SIZEOF_LONG_LONG)
-      SET(CURRENT_TEST_DEFINITIONS "${CURRENT_TEST_DEFINITIONS} -DHAVE_LONG_LONG")
-    endif(CMP_SIZEOF_LONG_LONG)
-    TRY_RUN(CMP_PRINTF_LL_TEST_RUN   CMP_PRINTF_LL_TEST_COMPILE
-      ${CMAKE_BINARY_DIR}/CMake
-      ${CMP_CORE_TESTS_SOURCE_DIR}/TestMiscFeatures.c
-      CMAKE_FLAGS -DCOMPILE_DEFINITIONS:STRING=${CURRENT_TEST_DEFINITIONS}
-      OUTPUT_VARIABLE OUTPUT)
-    if(CMP_PRINTF_LL_TEST_COMPILE)
-      if(CMP_PRINTF_LL_TEST_RUN MATCHES 0)
-        SET(CMP_PRINTF_LL_WIDTH "\"${CMP_PRINTF_LL}\"" CACHE INTERNAL "Width for printf for type `long long' or `__int64', us. `ll")
-        SET(PRINT_LL_FOUND 1)
-      ELSE (CMP_PRINTF_LL_TEST_RUN MATCHES 0)
-        MESSAGE("Width with ${CMP_PRINTF_LL} failed with result: ${CMP_PRINTF_LL_TEST_RUN}")
-      endif(CMP_PRINTF_LL_TEST_RUN MATCHES 0)
-    ELSE (CMP_PRINTF_LL_TEST_COMPILE)
-      FILE( APPEND ${CMAKE_BINARY_DIR}/CMakeFiles/CMakeError.log
-        "Test CMP_PRINTF_LL_WIDTH for ${CMP_PRINTF_LL} failed with the following output:\n ${OUTPUT}\n")
-    endif(CMP_PRINTF_LL_TEST_COMPILE)
-  ENDFOREACH(CMP_PRINTF_LL)
+  # The test program tries every candidate width itself, so the result does
+  # not depend on PRINTF_LL_WIDTH. This used to run the identical program once
+  # per candidate and keep the last one ("ll"); a single run gives the same answer.
+  SET(CMP_PRINTF_LL ll)
+  SET(CURRENT_TEST_DEFINITIONS "-DPRINTF_LL_WIDTH=${CMP_PRINTF_LL}")
+  if(CMP_SIZEOF_LONG_LONG)
+    SET(CURRENT_TEST_DEFINITIONS "${CURRENT_TEST_DEFINITIONS} -DHAVE_LONG_LONG")
+  endif(CMP_SIZEOF_LONG_LONG)
+  TRY_RUN(CMP_PRINTF_LL_TEST_RUN   CMP_PRINTF_LL_TEST_COMPILE
+    ${CMAKE_BINARY_DIR}/CMake
+    ${CMP_CORE_TESTS_SOURCE_DIR}/TestMiscFeatures.c
+    CMAKE_FLAGS -DCOMPILE_DEFINITIONS:STRING=${CURRENT_TEST_DEFINITIONS}
+    OUTPUT_VARIABLE OUTPUT)
+  if(CMP_PRINTF_LL_TEST_COMPILE)
+    if(CMP_PRINTF_LL_TEST_RUN MATCHES 0)
+      SET(CMP_PRINTF_LL_WIDTH "\"${CMP_PRINTF_LL}\"" CACHE INTERNAL "Width for printf for type `long long' or `__int64', us. `ll")
+      SET(PRINT_LL_FOUND 1)
+    ELSE (CMP_PRINTF_LL_TEST_RUN MATCHES 0)
+      MESSAGE("Width with ${CMP_PRINTF_LL} failed with result: ${CMP_PRINTF_LL_TEST_RUN}")
+    endif(CMP_PRINTF_LL_TEST_RUN MATCHES 0)
+  ELSE (CMP_PRINTF_LL_TEST_COMPILE)
+    FILE( APPEND ${CMAKE_BINARY_DIR}/CMakeFiles/CMakeError.log
+      "Test CMP_PRINTF_LL_WIDTH for ${CMP_PRINTF_LL} failed with the following output:\n ${OUTPUT}\n")
+  endif(CMP_PRINTF_LL_TEST_COMPILE)
   if(PRINT_LL_FOUND)
     MESSAGE(STATUS "Checking for apropriate format for 64 bit long: found ${CMP_PRINTF_LL_WIDTH}")
   ELSE (PRINT_LL_FOUND)
@@ -302,3 +540,46 @@ if(CMP_PRINTF_LL_WIDTH MATCHES "^CMP_PRINTF_LL_WIDTH$")
   endif(PRINT_LL_FOUND)
 endif(CMP_PRINTF_LL_WIDTH MATCHES "^CMP_PRINTF_LL_WIDTH$")
 
+
+#-----------------------------------------------------------------------------
+# Optional libnuma. Only the benchmark support of the unit tests uses it, to
+# place benchmark inputs on chosen NUMA nodes. Nothing requires it.
+#-----------------------------------------------------------------------------
+option(CMP_USE_LIBNUMA "Use libnuma, if it is found, to control the NUMA placement of benchmark data" ON)
+mark_as_advanced(CMP_USE_LIBNUMA)
+set(CMP_HAVE_LIBNUMA "")
+if(CMP_USE_LIBNUMA AND CMAKE_SYSTEM_NAME STREQUAL "Linux")
+  find_path(CMP_LIBNUMA_INCLUDE_DIR numa.h)
+  find_library(CMP_LIBNUMA_LIBRARY numa)
+  mark_as_advanced(CMP_LIBNUMA_INCLUDE_DIR CMP_LIBNUMA_LIBRARY)
+  if(CMP_LIBNUMA_INCLUDE_DIR AND CMP_LIBNUMA_LIBRARY)
+    set(CMP_HAVE_LIBNUMA 1)
+  endif()
+endif()
+
+
+#-----------------------------------------------------------------------------
+# Store the results for the next build directory that uses the same tool chain.
+# The file is written to a temporary name first and then renamed so that
+# concurrent configures never see a partially written file.
+#-----------------------------------------------------------------------------
+if(NOT "${CMP_CONFIGURE_CACHE_FILE}" STREQUAL "" AND NOT CMP_CONFIGURE_CACHE_LOADED AND NOT EXISTS "${CMP_CONFIGURE_CACHE_FILE}")
+  set(_cmp_cache_contents "# Generated by cmpConfigureChecks.cmake. Delete this file to run the checks again.\n")
+  get_cmake_property(_cmp_cache_vars CACHE_VARIABLES)
+  list(SORT _cmp_cache_vars)
+  foreach(_cmp_var ${_cmp_cache_vars})
+    # CHECK_TYPE_SIZE also caches the headers it includes in HAVE_<header>_H
+    if("${_cmp_var}" MATCHES "^(HAVE_)?CMP_(HAVE|SIZEOF|TYPE|COMPILER|PRINTF|WORDS)_" OR
+       "${_cmp_var}" MATCHES "^HAVE_(SYS_TYPES|STDINT|STDDEF)_H$")
+      # Read the cache entry itself, some checks shadow it with a normal variable
+      get_property(_cmp_value CACHE ${_cmp_var} PROPERTY VALUE)
+      string(REPLACE "\\" "\\\\" _cmp_value "${_cmp_value}")
+      string(REPLACE "\"" "\\\"" _cmp_value "${_cmp_value}")
+      string(REPLACE "$" "\\$" _cmp_value "${_cmp_value}")
+      string(APPEND _cmp_cache_contents "set(${_cmp_var} \"${_cmp_value}\" CACHE INTERNAL \"\")\n")
+    endif()
+  endforeach()
+  string(RANDOM LENGTH 8 _cmp_cache_suffix)
+  file(WRITE "${CMP_CONFIGURE_CACHE_FILE}.${_cmp_cache_suffix}.tmp" "${_cmp_cache_contents}")
+  file(RENAME "${CMP_CONFIGURE_CACHE_FILE}.${_cmp_cache_suffix}.tmp" "${CMP_CONFIGURE_CACHE_FILE}")
+endif()
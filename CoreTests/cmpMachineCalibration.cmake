@@ -0,0 +1,80 @@
+#-----------------------------------------------------------------------------
+# Machine calibration. The micro benchmarks in cmpMachineCalibration.cpp measure
+# memory bandwidth, cache latencies, peak FLOP rate and thread fork/join cost of
+# the build machine. They take several seconds, so they are run once per machine
+# and the results are kept in CMP_CONFIGURE_CACHE_DIR next to the cached
+# configure checks. The results end up in CMP_MACHINE_CALIBRATION_FILE which the
+# benchmark support of the unit tests attaches to every benchmark report.
+#-----------------------------------------------------------------------------
+option(CMP_MACHINE_CALIBRATION "Measure the performance characteristics of this machine for the benchmark reports" OFF)
+
+set(CMP_MACHINE_CALIBRATION_FILE "")
+if(NOT CMP_MACHINE_CALIBRATION OR CMAKE_CROSSCOMPILING)
+  return()
+endif()
+
+# The key only depends on the CPU model and its core counts, not on the host name,
+# the build directory or the build type. Identical machines, e.g. the nodes of a
+# build farm that share CMP_CONFIGURE_CACHE_DIR, share one calibration.
+cmake_host_system_information(RESULT _cmp_host_info QUERY PROCESSOR_NAME PROCESSOR_DESCRIPTION
+                              NUMBER_OF_LOGICAL_CORES NUMBER_OF_PHYSICAL_CORES)
+file(MD5 "${CMP_CORE_TESTS_SOURCE_DIR}/cmpMachineCalibration.cpp" _cmp_calibration_md5)
+string(SHA1 _cmp_calibration_key "${_cmp_host_info};${CMAKE_HOST_SYSTEM};${_cmp_calibration_md5}")
+
+set(_cmp_calibration_cache "")
+if(NOT "${CMP_CONFIGURE_CACHE_DIR}" STREQUAL "")
+  set(_cmp_calibration_cache "${CMP_CONFIGURE_CACHE_DIR}/MachineCalibration-${_cmp_calibration_key}.json")
+endif()
+set(CMP_MACHINE_CALIBRATION_FILE "${PROJECT_BINARY_DIR}/MachineCalibration.json")
+
+if(NOT "${_cmp_calibration_cache}" STREQUAL "" AND EXISTS "${_cmp_calibration_cache}")
+  file(READ "${_cmp_calibration_cache}" _cmp_calibration_json)
+elseif("${CMP_MACHINE_CALIBRATION_KEY}" STREQUAL "${_cmp_calibration_key}" AND EXISTS "${CMP_MACHINE_CALIBRATION_FILE}")
+  file(READ "${CMP_MACHINE_CALIBRATION_FILE}" _cmp_calibration_json)
+else()
+  # Optimize the way a release build would, including the instruction set of the host
+  set(_cmp_calibration_flags "")
+  if(MSVC)
+    set(_cmp_calibration_flags /O2)
+  elseif(CMAKE_CXX_COMPILER_ID MATCHES "GNU|Clang")
+    include(CheckCXXCompilerFlag)
+    check_cxx_compiler_flag(-march=native CMP_COMPILER_HAS_MARCH_NATIVE)
+    set(_cmp_calibration_flags -O3)
+    if(CMP_COMPILER_HAS_MARCH_NATIVE)
+      list(APPEND _cmp_calibration_flags -march=native)
+    endif()
+  endif()
+  find_package(Threads)
+
+  message(STATUS "Calibrating this machine (runs once per machine, takes a few seconds)")
+  try_run(_cmp_calibration_run _cmp_calibration_compiled
+          ${PROJECT_BINARY_DIR}/CMakeTmp/MachineCalibration
+          ${CMP_CORE_TESTS_SOURCE_DIR}/cmpMachineCalibration.cpp
+          COMPILE_DEFINITIONS ${_cmp_calibration_flags}
+          LINK_LIBRARIES ${CMAKE_THREAD_LIBS_INIT}
+          COMPILE_OUTPUT_VARIABLE _cmp_calibration_compile_output
+          RUN_OUTPUT_VARIABLE _cmp_calibration_output)
+
+  set(_cmp_calibration_json "")
+  if(_cmp_calibration_compiled AND "${_cmp_calibration_run}" STREQUAL "0"
+     AND "${_cmp_calibration_output}" MATCHES "CMP_CALIBRATION_BEGIN(.*)CMP_CALIBRATION_END")
+    set(_cmp_calibration_json "${CMAKE_MATCH_1}")
+    message(STATUS "Calibrating this machine -- ${_cmp_calibration_json}")
+    if(NOT "${_cmp_calibration_cache}" STREQUAL "")
+      string(RANDOM LENGTH 8 _cmp_calibration_suffix)
+      file(WRITE "${_cmp_calibration_cache}.${_cmp_calibration_suffix}.tmp" "${_cmp_calibration_json}")
+      file(RENAME "${_cmp_calibration_cache}.${_cmp_calibration_suffix}.tmp" "${_cmp_calibration_cache}")
+    endif()
+  else()
+    message(STATUS "Calibrating this machine -- failed")
+    file(APPEND ${CMAKE_BINARY_DIR}/CMakeFiles/CMakeError.log
+      "Machine calibration failed with the following output:\n${_cmp_calibration_compile_output}\n${_cmp_calibration_output}\n")
+  endif()
+endif()
+
+if("${_cmp_calibration_json}" STREQUAL "")
+  set(CMP_MACHINE_CALIBRATION_FILE "")
+else()
+  set(CMP_MACHINE_CALIBRATION_KEY "${_cmp_calibration_key}" CACHE INTERNAL "Host key of the last machine calibration")
+  cmpWriteFileIfDifferent(FILE_PATH "${CMP_MACHINE_CALIBRATION_FILE}" CONTENT "${_cmp_calibration_json}")
+endif()
@@ -0,0 +1,350 @@
+/* Machine calibration micro benchmarks.
+ *
+ * This program is compiled and run once per machine by cmpMachineCalibration.cmake.
+ * It measures the numbers that decide whether a kernel is bound by memory or by
+ * compute on this host:
+ *   - STREAM style copy/scale/add/triad bandwidth on one thread and on all threads
+ *   - load-to-use latency of a dependent pointer chase inside each cache level and in DRAM
+ *   - peak double precision FLOP rate of a single core and the number of physical
+ *     cores it can be multiplied with
+ *   - the cost of starting and joining one thread per hardware thread
+ * The results are printed as a single JSON object between the CMP_CALIBRATION_BEGIN
+ * and CMP_CALIBRATION_END markers.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+double Seconds(Clock::time_point start, Clock::time_point stop)
+{
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+/* Keeps the optimizer from removing a computation whose result is otherwise unused */
+volatile double g_Sink = 0.0;
+
+size_t CacheSize(int level)
+{
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+  long size = -1;
+  switch(level)
+  {
+  case 1:
+    size = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+    break;
+  case 2:
+    size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    break;
+  case 3:
+    size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    break;
+  default:
+    break;
+  }
+  if(size > 0)
+  {
+    return static_cast<size_t>(size);
+  }
+#endif
+  /* Typical values when the operating system does not tell */
+  return level == 1 ? 32 * 1024 : (level == 2 ? 1024 * 1024 : 32 * 1024 * 1024);
+}
+
+unsigned NumThreads()
+{
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/* Cores without their SMT siblings, which share the floating point units. Every
+ * distinct (package, core) pair of the sysfs topology is one physical core. */
+unsigned NumPhysicalCores()
+{
+  std::set<std::pair<int, int>> cores;
+#if defined(__linux__) && defined(_SC_NPROCESSORS_CONF)
+  const long numCpus = sysconf(_SC_NPROCESSORS_CONF);
+  for(long cpu = 0; cpu < numCpus; cpu++)
+  {
+    std::string topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+    int ids[2] = {-1, -1};
+    const char* names[2] = {"physical_package_id", "core_id"};
+    for(int i = 0; i < 2; i++)
+    {
+      FILE* file = fopen((topology + names[i]).c_str(), "r");
+      if(nullptr != file)
+      {
+        if(fscanf(file, "%d", &ids[i]) != 1)
+        {
+          ids[i] = -1;
+        }
+        fclose(file);
+      }
+    }
+    if(ids[0] >= 0 && ids[1] >= 0)
+    {
+      cores.insert(std::make_pair(ids[0], ids[1]));
+    }
+  }
+#endif
+  /* Without a topology every hardware thread counts as a core */
+  return cores.empty() ? NumThreads() : static_cast<unsigned>(std::min<size_t>(cores.size(), NumThreads()));
+}
+
+/* ------------------------------------------------------------------------- */
+/* STREAM style bandwidth. Every kernel is run several times and the best time
+ * is kept, just like the original STREAM benchmark. Bytes are counted the way
+ * STREAM does: copy and scale move 2 words per element, add and triad move 3. */
+struct StreamResult
+{
+  double Copy;
+  double Scale;
+  double Add;
+  double Triad;
+};
+
+void StreamKernels(double* a, double* b, double* c, size_t begin, size_t end, int kernel)
+{
+  const double scalar = 3.0;
+  switch(kernel)
+  {
+  case 0:
+    for(size_t i = begin; i < end; i++)
+    {
+      c[i] = a[i];
+    }
+    break;
+  case 1:
+    for(size_t i = begin; i < end; i++)
+    {
+      b[i] = scalar * c[i];
+    }
+    break;
+  case 2:
+    for(size_t i = begin; i < end; i++)
+    {
+      c[i] = a[i] + b[i];
+    }
+    break;
+  default:
+    for(size_t i = begin; i < end; i++)
+    {
+      a[i] = b[i] + scalar * c[i];
+    }
+    break;
+  }
+}
+
+StreamResult MeasureStream(size_t count, unsigned numThreads)
+{
+  std::vector<double> a(count), b(count), c(count);
+  const size_t chunk = (count + numThreads - 1) / numThreads;
+
+  /* First touch from the threads that will use the memory */
+  std::vector<std::thread> threads;
+  for(unsigned t = 0; t < numThreads; t++)
+  {
+    threads.emplace_back([&, t]() {
+      size_t end = std::min(count, (t + 1) * chunk);
+      for(size_t i = t * chunk; i < end; i++)
+      {
+        a[i] = 1.0;
+        b[i] = 2.0;
+        c[i] = 0.0;
+      }
+    });
+  }
+  for(std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  double best[4] = {1.0e30, 1.0e30, 1.0e30, 1.0e30};
+  for(int trial = 0; trial < 3; trial++)
+  {
+    for(int kernel = 0; kernel < 4; kernel++)
+    {
+      Clock::time_point start = Clock::now();
+      if(numThreads == 1)
+      {
+        StreamKernels(a.data(), b.data(), c.data(), 0, count, kernel);
+      }
+      else
+      {
+        threads.clear();
+        for(unsigned t = 0; t < numThreads; t++)
+        {
+          threads.emplace_back([&, t, kernel]() { StreamKernels(a.data(), b.data(), c.data(), t * chunk, std::min(count, (t + 1) * chunk), kernel); });
+        }
+        for(std::thread& thread : threads)
+        {
+          thread.join();
+        }
+      }
+      best[kernel] = std::min(best[kernel], Seconds(start, Clock::now()));
+    }
+  }
+  g_Sink = g_Sink + a[count / 2] + b[count / 3] + c[count / 5];
+
+  const double bytes = static_cast<double>(count * sizeof(double));
+  StreamResult result;
+  result.Copy = 2.0 * bytes / best[0] / 1.0e9;
+  result.Scale = 2.0 * bytes / best[1] / 1.0e9;
+  result.Add = 3.0 * bytes / best[2] / 1.0e9;
+  result.Triad = 3.0 * bytes / best[3] / 1.0e9;
+  return result;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Latency of a dependent load inside a working set of 'bytes'. The chase visits
+ * one element per cache line in a random cyclic order so the hardware
+ * prefetchers can not hide the latency. */
+double MeasureLatency(size_t bytes)
+{
+  const size_t stride = 64 / sizeof(size_t);
+  const size_t lines = std::max<size_t>(bytes / 64, 16);
+  std::vector<size_t> order(lines);
+  std::iota(order.begin(), order.end(), 0);
+  std::mt19937_64 rng(0x5EED);
+  std::shuffle(order.begin() + 1, order.end(), rng);
+
+  std::vector<size_t> chain(lines * stride, 0);
+  for(size_t i = 0; i < lines; i++)
+  {
+    chain[order[i] * stride] = order[(i + 1) % lines] * stride;
+  }
+
+  /* A few milliseconds when everything hits L1, well under a second in DRAM */
+  const size_t loads = 4 * 1024 * 1024;
+  size_t p = 0;
+  for(size_t i = 0; i < lines; i++)
+  {
+    p = chain[p];
+  }
+  double best = 1.0e30;
+  for(int trial = 0; trial < 3; trial++)
+  {
+    Clock::time_point start = Clock::now();
+    for(size_t i = 0; i < loads; i++)
+    {
+      p = chain[p];
+    }
+    best = std::min(best, Seconds(start, Clock::now()));
+  }
+  g_Sink = g_Sink + static_cast<double>(p);
+  return best / loads * 1.0e9;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Peak floating point rate of one core. Many independent multiply-add chains
+ * hide the latency of the FMA units; the compiler vectorizes the inner loop
+ * for whatever instruction set the calibration was compiled for. */
+double MeasurePeakFlops()
+{
+  const int lanes = 64;
+  double x[lanes];
+  for(int i = 0; i < lanes; i++)
+  {
+    x[i] = 1.0 + i * 1.0e-9;
+  }
+  const double m = 0.999999999;
+  const double a = 1.0e-9;
+  const long repeats = 4 * 1000 * 1000;
+
+  double best = 1.0e30;
+  for(int trial = 0; trial < 3; trial++)
+  {
+    Clock::time_point start = Clock::now();
+    for(long r = 0; r < repeats; r++)
+    {
+      for(int i = 0; i < lanes; i++)
+      {
+        x[i] = x[i] * m + a;
+      }
+    }
+    best = std::min(best, Seconds(start, Clock::now()));
+  }
+  double sum = 0.0;
+  for(int i = 0; i < lanes; i++)
+  {
+    sum += x[i];
+  }
+  g_Sink = g_Sink + sum;
+  return 2.0 * lanes * static_cast<double>(repeats) / best / 1.0e9;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Microseconds to start and join one thread per hardware thread */
+double MeasureForkJoin(unsigned numThreads)
+{
+  const int rounds = 200;
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads);
+  Clock::time_point start = Clock::now();
+  for(int r = 0; r < rounds; r++)
+  {
+    for(unsigned t = 0; t < numThreads; t++)
+    {
+      threads.emplace_back([]() { g_Sink = g_Sink + 1.0; });
+    }
+    for(std::thread& thread : threads)
+    {
+      thread.join();
+    }
+    threads.clear();
+  }
+  return Seconds(start, Clock::now()) / rounds * 1.0e6;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  (void)argc;
+  (void)argv;
+  const unsigned numThreads = NumThreads();
+  const size_t l1 = CacheSize(1);
+  const size_t l2 = CacheSize(2);
+  const size_t l3 = CacheSize(3);
+
+  /* Each STREAM array must be well beyond the last level cache, but the calibration
+   * should neither take minutes nor need gigabytes on hosts with a huge shared L3 */
+  const size_t streamCount = std::min<size_t>(std::max<size_t>(4 * l3 / sizeof(double), 4 * 1024 * 1024), 16 * 1024 * 1024);
+  StreamResult single = MeasureStream(streamCount, 1);
+  StreamResult all = MeasureStream(streamCount, numThreads);
+
+  std::ostringstream json;
+  json.precision(6);
+  json << "{";
+  json << "\"hardware_threads\":" << numThreads;
+  json << ",\"physical_cores\":" << NumPhysicalCores();
+  json << ",\"l1d_bytes\":" << l1 << ",\"l2_bytes\":" << l2 << ",\"l3_bytes\":" << l3;
+  json << ",\"stream_copy_gbs\":" << single.Copy << ",\"stream_scale_gbs\":" << single.Scale << ",\"stream_add_gbs\":" << single.Add << ",\"stream_triad_gbs\":" << single.Triad;
+  json << ",\"stream_triad_all_threads_gbs\":" << all.Triad << ",\"stream_copy_all_threads_gbs\":" << all.Copy;
+  json << ",\"latency_l1_ns\":" << MeasureLatency(l1 / 2);
+  json << ",\"latency_l2_ns\":" << MeasureLatency(l2 / 2);
+  json << ",\"latency_l3_ns\":" << MeasureLatency(l3 / 2);
+  json << ",\"latency_dram_ns\":" << MeasureLatency(std::min<size_t>(std::max<size_t>(4 * l3, 64 * 1024 * 1024), 256 * 1024 * 1024));
+  json << ",\"peak_gflops_single_core\":" << MeasurePeakFlops();
+  json << ",\"fork_join_us\":" << MeasureForkJoin(numThreads);
+  json << "}";
+
+  printf("CMP_CALIBRATION_BEGIN%sCMP_CALIBRATION_END\n", json.str().c_str());
+  return 0;
+}
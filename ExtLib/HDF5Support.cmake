@@ -102,7 +102,7 @@ if(HDF5_FOUND)
 
     GET_FILENAME_COMPONENT (HDF5_LIBRARY_DIRS "${HDF5_INCLUDE_DIR}" PATH)
     set(HDF5_LIBRARY_DIRS ${HDF5_LIBRARY_DIRS}/lib)
-    file(APPEND ${CMP_PLUGIN_SEARCHDIR_FILE} "${HDF5_LIBRARY_DIRS};")
+    cmpAppendGeneratedFile(FILE_PATH ${CMP_PLUGIN_SEARCHDIR_FILE} CONTENT "${HDF5_LIBRARY_DIRS};")
   endif()
 
   if(MSVC_IDE)
@@ -103,7 +103,7 @@ if(libharu_FOUND)
 
     GET_FILENAME_COMPONENT (libharu_LIBRARY_DIRS "${libharu_INCLUDE_DIR}" PATH)
     set(libharu_LIBRARY_DIRS ${libharu_LIBRARY_DIRS}/lib)
-    file(APPEND ${CMP_PLUGIN_SEARCHDIR_FILE} "${libharu_LIBRARY_DIRS};")
+    cmpAppendGeneratedFile(FILE_PATH ${CMP_PLUGIN_SEARCHDIR_FILE} CONTENT "${libharu_LIBRARY_DIRS};")
   endif()
 
   if(MSVC_IDE)
@@ -306,10 +306,10 @@ function(AddQt5Plugins)
       endif()
 
       # Create the qt.conf file so that the image plugins will be loaded correctly
-      FILE(WRITE ${PROJECT_BINARY_DIR}/qt.conf "[Paths]\nPlugins = ${QTPLUGINS_DIR}Plugins\n")
-      FILE(APPEND ${PROJECT_BINARY_DIR}/qt.conf "Prefix = .\n")
-      FILE(APPEND ${PROJECT_BINARY_DIR}/qt.conf "LibraryExecutables = .\n")
-      FILE(APPEND ${PROJECT_BINARY_DIR}/qt.conf "Data = .\n")
+      cmpWriteGeneratedFile(FILE_PATH ${PROJECT_BINARY_DIR}/qt.conf CONTENT "[Paths]\nPlugins = ${QTPLUGINS_DIR}Plugins\n")
+      cmpAppendGeneratedFile(FILE_PATH ${PROJECT_BINARY_DIR}/qt.conf CONTENT "Prefix = .\n")
+      cmpAppendGeneratedFile(FILE_PATH ${PROJECT_BINARY_DIR}/qt.conf CONTENT "LibraryExecutables = .\n")
+      cmpAppendGeneratedFile(FILE_PATH ${PROJECT_BINARY_DIR}/qt.conf CONTENT "Data = .\n")
 
       install(FILES ${PROJECT_BINARY_DIR}/qt.conf
               DESTINATION ${QTCONF_DIR}
@@ -511,8 +511,8 @@ macro(CMP_AddQt5Support Qt5Components NeedQtWebEngine ProjectBinaryDir VarPrefix
 
 
 
-  file(WRITE ${QT_PLUGINS_FILE_TEMPLATE} "")
-  file(WRITE ${QT_PLUGINS_FILE} "")
+  cmpWriteGeneratedFile(FILE_PATH ${QT_PLUGINS_FILE_TEMPLATE} CONTENT "")
+  cmpWriteGeneratedFile(FILE_PATH ${QT_PLUGINS_FILE} CONTENT "")
 
 
   list(FIND Qt5_COMPONENTS "Gui" NeedsGui)
@@ -107,7 +107,9 @@ set(CMAKE_MODULE_PATH ${CMP_MODULES_SOURCE_DIR} ${CMAKE_MODULE_PATH})
 find_package(Qwt)
 if(QWT_FOUND)
     get_property(SIMPLibSearchDirs GLOBAL PROPERTY SIMPLibSearchDirs)
-		file(APPEND "${SIMPLibSearchDirs}" "${QWT_LIB_DIR};")
+    if(NOT "${SIMPLibSearchDirs}" STREQUAL "")
+      cmpAppendGeneratedFile(FILE_PATH "${SIMPLibSearchDirs}" CONTENT "${QWT_LIB_DIR};")
+    endif()
     AddQwtCopyInstallRules(PREFIX "" CMAKE_VAR QWT_LIBRARY)
 else()
     message(FATAL_ERROR "Qwt is required for this project")
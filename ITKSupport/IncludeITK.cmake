@@ -174,7 +174,7 @@ if(NOT Itk_STATUS_PRINTED)
   # Now append ITK_RUNTIME_LIBRARY_DIRS path to the SIMPLibSearchDirs property
   get_property(SIMPLibSearchDirs GLOBAL PROPERTY SIMPLibSearchDirs)
   if(NOT "${SIMPLibSearchDirs}" STREQUAL "")
-    file(APPEND "${SIMPLibSearchDirs}" "${ITK_RUNTIME_LIBRARY_DIRS};")
+    cmpAppendGeneratedFile(FILE_PATH "${SIMPLibSearchDirs}" CONTENT "${ITK_RUNTIME_LIBRARY_DIRS};")
   endif()
 
 endif()
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+#------------------------------------------------------------------------------
+# Records the shared objects an installed application loads while it starts,
+# the Qt and project plugins it dlopen()s included, into
+# <InstallPrefix>/lib/<executable>.prefetch. The launch script and the
+# CMP_LINUX_PREFETCH_LIST startup code read the listed files ahead so a cold
+# start does not fault them in one page at a time.
+#
+# The application is started once with LD_DEBUG=libs, the offscreen Qt platform
+# and no display. It is stopped after CMP_PREFETCH_RECORD_TIMEOUT seconds
+# (default 15) if it does not exit by itself. If nothing was recorded the list
+# falls back to the libraries the loader resolves for the executable.
+#
+# Usage: RecordPrefetchList.sh <InstallPrefix> <Executable> [<arguments> ...]
+# Files inside of the InstallPrefix are stored relative to it so the installed
+# tree can be moved.
+
+if [ ! -d "${1}" ] || [ ! -x "${2}" ]; then
+  echo "RecordPrefetchList: Usage: RecordPrefetchList.sh <InstallPrefix> <Executable> [<arguments> ...]"
+  exit 1
+fi
+
+InstallPrefix=`cd "${1}" && pwd -P`
+Executable=`readlink -f "${2}"`
+shift 2
+ListFile="${InstallPrefix}/lib/`basename "${Executable}"`.prefetch"
+Timeout=${CMP_PREFETCH_RECORD_TIMEOUT:-15}
+
+WorkDir=`mktemp -d`
+trap 'rm -rf "${WorkDir}"' EXIT
+
+echo "RecordPrefetchList: Recording the startup of `basename "${Executable}"`"
+( cd "${InstallPrefix}" && \
+  CMP_PREFETCH_DISABLE=1 QT_QPA_PLATFORM=${QT_QPA_PLATFORM:-offscreen} \
+  LD_DEBUG=libs LD_DEBUG_OUTPUT="${WorkDir}/ld" \
+  timeout -s KILL ${Timeout} "${Executable}" "$@" > /dev/null 2>&1 < /dev/null )
+
+# glibc reports every object whose initializers run, in load order
+cat "${WorkDir}"/ld.* 2> /dev/null | sed -n 's/^.*calling init: //p' > "${WorkDir}/objects"
+if [ ! -s "${WorkDir}/objects" ]; then
+  echo "RecordPrefetchList: Nothing was recorded, listing the libraries of the executable instead"
+  LD_TRACE_LOADED_OBJECTS=1 "${Executable}" 2> /dev/null | sed -n 's/^.*=> \(\/[^ ]*\) (0x.*$/\1/p' > "${WorkDir}/objects"
+fi
+
+{
+  echo "# Files read ahead when `basename "${Executable}"` starts. Written by RecordPrefetchList.sh"
+  echo "${Executable}"
+  while read -r object; do
+    if [ -f "${object}" ]; then
+      readlink -f "${object}"
+    fi
+  done < "${WorkDir}/objects"
+} | awk '!seen[$0]++' | sed "s,^${InstallPrefix}/,," > "${ListFile}"
+
+echo "RecordPrefetchList: Wrote `grep -vc '^#' "${ListFile}"` files to ${ListFile}"
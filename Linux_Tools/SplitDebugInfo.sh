@@ -0,0 +1,98 @@
+#!/bin/bash
+
+#------------------------------------------------------------------------------
+# Moves the debug information of installed ELF binaries into a separate symbol
+# directory and strips the installed copies. The debug files are stored under
+# <SymbolDir>/.build-id/xx/yyyyyyyy.debug so that gdb, perf and the other tools
+# that honor build-id links find them without any further setup. If the binary
+# was compiled with -gsplit-dwarf the .dwo files are packed into a .dwp file
+# that is stored next to the build-id tree.
+#
+# Usage: SplitDebugInfo.sh <SymbolDir> <binary|directory> [<binary|directory> ...]
+# Directories are searched for shared libraries and executables. Binaries that
+# already carry a .gnu_debuglink section are skipped, so running this more than
+# once on the same install tree is safe.
+
+SymbolDir="${1}"
+shift
+
+if [ -z "${SymbolDir}" ]; then
+  echo "SplitDebugInfo: No symbol directory was given"
+  exit 1
+fi
+
+OBJCOPY=${OBJCOPY:-objcopy}
+READELF=${READELF:-readelf}
+# GNU dwp does not understand DWARF 5, which is what current compilers emit
+if [ -z "${DWP}" ]; then
+  if command -v llvm-dwp > /dev/null 2>&1; then
+    DWP=llvm-dwp
+  else
+    DWP=dwp
+  fi
+fi
+
+if ! command -v ${OBJCOPY} > /dev/null 2>&1 || ! command -v ${READELF} > /dev/null 2>&1; then
+  echo "SplitDebugInfo: objcopy and readelf are needed to split the debug information. Binaries are installed as is."
+  exit 0
+fi
+
+#------------------------------------------------------------------------------
+# Splits a single binary
+function splitBinary()
+{
+  binary="$1"
+
+  # Only real ELF files, the .so symlinks point at a file that is handled anyway
+  if [ -L "${binary}" ] || [ ! -f "${binary}" ]; then
+    return
+  fi
+  if [ "$(head -c 4 "${binary}" | tr -d '\177')" != "ELF" ]; then
+    return
+  fi
+  if ${READELF} -S "${binary}" 2> /dev/null | grep -q "\.gnu_debuglink"; then
+    return
+  fi
+  if ! ${READELF} -S "${binary}" 2> /dev/null | grep -q "\.debug_info\|\.gnu_debugaltlink\|\.debug_addr"; then
+    return
+  fi
+
+  name=`basename "${binary}"`
+  buildId=`${READELF} -n "${binary}" 2> /dev/null | sed -n 's/.*Build ID: *\([0-9a-f]*\).*/\1/p' | head -n 1`
+  if [ -n "${buildId}" ]; then
+    debugFile="${SymbolDir}/.build-id/${buildId:0:2}/${buildId:2}.debug"
+  else
+    echo "SplitDebugInfo: ${name} has no build-id, storing its symbols by name"
+    debugFile="${SymbolDir}/${name}.debug"
+  fi
+  mkdir -p "`dirname "${debugFile}"`" || return
+
+  echo "SplitDebugInfo: ${name} -> ${debugFile}"
+  ${OBJCOPY} --only-keep-debug --compress-debug-sections "${binary}" "${debugFile}" || return
+
+  # Pack the split DWARF objects. gdb looks for <name>.dwp in its debug-file-directory.
+  if ${READELF} -S "${binary}" 2> /dev/null | grep -q "\.debug_addr" && command -v ${DWP} > /dev/null 2>&1; then
+    ( ${DWP} -e "${binary}" -o "${SymbolDir}/${name}.dwp" ) > /dev/null 2>&1 || echo "SplitDebugInfo: ${DWP} could not create ${name}.dwp, the .dwo files in the build directory are still needed for debugging"
+  fi
+
+  chmod u+w "${binary}"
+  ${OBJCOPY} --strip-debug --strip-unneeded "${binary}" || return
+  ${OBJCOPY} --add-gnu-debuglink="${debugFile}" "${binary}"
+}
+
+# The exit status is that of the last binary that could not be split
+status=0
+for target in "$@"
+do
+  if [ -d "${target}" ]; then
+    # NUL separated, so paths with spaces survive. Not a pipe, which would run
+    # the loop in a subshell and lose the status.
+    while IFS= read -r -d '' f
+    do
+      splitBinary "${f}" || status=$?
+    done < <(find "${target}" -type f \( -name "*.so*" -o -perm -u+x \) -print0)
+  else
+    splitBinary "${target}" || status=$?
+  fi
+done
+exit ${status}
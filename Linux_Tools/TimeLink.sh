@@ -0,0 +1,48 @@
+#!/bin/bash
+
+#------------------------------------------------------------------------------
+# Link launcher of the CMP_FAST_LINK_PROFILE (see cmpFastLinkProfile). Runs the
+# link command, prints how long it took and appends "<seconds> <target>" to the
+# log file so that the slowest links of a build can be listed afterwards.
+#
+# Usage: TimeLink.sh <LogFile> <Target> <link command ...>
+#        TimeLink.sh --report <LogFile> [<Count>]
+# The report lists the latest link time of every target, slowest first.
+
+if [ "${1}" = "--report" ]; then
+  LogFile="${2}"
+  Count="${3:-20}"
+  if [ ! -f "${LogFile}" ]; then
+    echo "TimeLink: No links were recorded in ${LogFile} yet"
+    exit 0
+  fi
+  echo "Slowest links (latest link of each target, from ${LogFile}):"
+  # Keep the last entry of every target, then sort by time
+  awk '{ time[$2] = $1 } END { for (t in time) printf "%10.3f s  %s\n", time[t], t }' "${LogFile}" | sort -rn | head -n "${Count}"
+  awk '{ time[$2] = $1 } END { for (t in time) { total += time[t]; n++ } printf "%10.3f s  total over %d targets\n", total, n }' "${LogFile}"
+  exit 0
+fi
+
+LogFile="${1}"
+Target="${2}"
+shift 2
+
+now() {
+  if [ -n "${EPOCHREALTIME}" ]; then
+    echo "${EPOCHREALTIME/,/.}"
+  else
+    date +%s.%N
+  fi
+}
+
+Start=$(now)
+"$@"
+Status=$?
+End=$(now)
+
+Seconds=$(awk -v s="${Start}" -v e="${End}" 'BEGIN { printf "%.3f", e - s }')
+if [ ${Status} -eq 0 ]; then
+  echo "Linked ${Target} in ${Seconds} s"
+  echo "${Seconds} ${Target}" >> "${LogFile}"
+fi
+exit ${Status}
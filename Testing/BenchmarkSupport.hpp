@@ -0,0 +1,1468 @@
+/* ============================================================================
+* Copyright (c) 2009-2016 BlueQuartz Software, LLC
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* Redistributions in binary form must reproduce the above copyright notice, this
+* list of conditions and the following disclaimer in the documentation and/or
+* other materials provided with the distribution.
+*
+* Neither the name of BlueQuartz Software, the US Air Force, nor the names of its
+* contributors may be used to endorse or promote products derived from this software
+* without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* The code contained herein was partially funded by the followig contracts:
+*    United States Air Force Prime Contract FA8650-07-D-5800
+*    United States Air Force Prime Contract FA8650-10-D-5210
+*    United States Prime Contract Navy N00173-07-C-2068
+*
+* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+//-- C Includes
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(SIMPL_HAVE_LIBNUMA)
+#include <numa.h>
+#endif
+
+// The latency histogram that CMP generates next to cmpConfiguration.h, see AddSIMPLUnitTest
+#if defined(SIMPL_LATENCY_HISTOGRAM_HEADER)
+#include SIMPL_LATENCY_HISTOGRAM_HEADER
+#define SIMPL_HAVE_LATENCY_HISTOGRAM 1
+#endif
+
+//-- C++ Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "UnitTestSupport.hpp"
+
+namespace SIMPL
+{
+namespace unittest
+{
+// -----------------------------------------------------------------------------
+// Options that are set from the command line of the generated test executable
+// -----------------------------------------------------------------------------
+struct BenchmarkOptions
+{
+  bool Stable = false;          // --bench-stable
+  bool ColdCache = false;       // --bench-cold-cache
+  std::vector<int> Cpus;        // --bench-cpus=2,3 (defaults to the isolated cores)
+  int Iterations = 0;           // --bench-iterations=N (0 uses the value given by the test)
+  std::string ResultsFile;      // --bench-results=path (or SIMPL_BENCHMARK_RESULTS)
+  std::vector<std::string> Warnings;
+  std::vector<std::string> Governors;
+  std::string TurboState = "unknown";
+  size_t LastLevelCacheSize = 0;
+  std::string MachineCalibration; // JSON from --bench-calibration=path, SIMPL_MACHINE_CALIBRATION or CMP_MACHINE_CALIBRATION
+  std::string NumaPlacement = "default"; // --bench-numa=default|local|interleave|node:N for numa::Array inputs
+  int NumaCpuNode = -1;                  // --bench-numa-cpu-node=N runs the benchmark on the cpus of node N (that are in --bench-cpus=)
+  std::string Allocator;                 // Library that provides malloc(), see benchmark::ReadAllocator()
+};
+
+/**
+ * @brief The amount of work one run of a benchmark does. When it is given the
+ * report relates the achieved rates to the calibrated peaks of the machine.
+ */
+struct BenchmarkWork
+{
+  double Bytes = 0.0;    // Bytes moved to and from memory
+  double Flops = 0.0;    // Floating point operations
+  double Elements = 0.0; // Elements processed, the time and the energy are also reported per element
+};
+
+inline BenchmarkOptions& GetBenchmarkOptions()
+{
+  static BenchmarkOptions options;
+  return options;
+}
+
+#if defined(SIMPL_HAVE_LATENCY_HISTOGRAM)
+/**
+ * @brief Latencies of single operations inside a benchmark. RunBenchmark clears it
+ * after the warm up run and reports its percentiles if the benchmark recorded
+ * anything, e.g.
+ *   cmp::ScopedLatency timer(SIMPL::unittest::BenchmarkLatencies());
+ */
+inline cmp::LatencyHistogram& BenchmarkLatencies()
+{
+  static cmp::LatencyHistogram histogram;
+  return histogram;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Small helper that builds one JSON object per benchmark result so that every
+// benchmark run ends up as a single line in the results file.
+// -----------------------------------------------------------------------------
+class BenchmarkRecord
+{
+public:
+  static std::string Escape(const std::string& value)
+  {
+    std::string out;
+    for(char c : value)
+    {
+      switch(c)
+      {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += c;
+      }
+    }
+    return out;
+  }
+
+  void add(const std::string& key, const std::string& value)
+  {
+    addRaw(key, "\"" + Escape(value) + "\"");
+  }
+  void add(const std::string& key, const char* value)
+  {
+    add(key, std::string(value));
+  }
+  void add(const std::string& key, double value)
+  {
+    std::stringstream ss;
+    ss << std::setprecision(12) << value;
+    addRaw(key, ss.str());
+  }
+  void add(const std::string& key, int64_t value)
+  {
+    addRaw(key, std::to_string(value));
+  }
+  void add(const std::string& key, bool value)
+  {
+    addRaw(key, value ? "true" : "false");
+  }
+  void add(const std::string& key, const std::vector<double>& values)
+  {
+    std::stringstream ss;
+    ss << std::setprecision(12) << "[";
+    for(size_t i = 0; i < values.size(); i++)
+    {
+      ss << (i > 0 ? "," : "") << values[i];
+    }
+    addRaw(key, ss.str() + "]");
+  }
+  void add(const std::string& key, const std::vector<std::string>& values)
+  {
+    std::string raw = "[";
+    for(size_t i = 0; i < values.size(); i++)
+    {
+      raw += (i > 0 ? ",\"" : "\"") + Escape(values[i]) + "\"";
+    }
+    addRaw(key, raw + "]");
+  }
+  void addRaw(const std::string& key, const std::string& json)
+  {
+    m_Fields.push_back(std::make_pair(key, json));
+  }
+
+  std::string toJson() const
+  {
+    std::string out = "{";
+    for(size_t i = 0; i < m_Fields.size(); i++)
+    {
+      out += (i > 0 ? ",\"" : "\"") + Escape(m_Fields[i].first) + "\":" + m_Fields[i].second;
+    }
+    return out + "}";
+  }
+
+private:
+  std::vector<std::pair<std::string, std::string>> m_Fields;
+};
+
+namespace benchmark
+{
+/**
+ * @brief Reads the first line of a (sysfs) file. Returns an empty string if the
+ * file can not be read.
+ */
+inline std::string ReadFirstLine(const std::string& filePath)
+{
+  std::ifstream in(filePath.c_str());
+  std::string line;
+  if(in.is_open())
+  {
+    std::getline(in, line);
+  }
+  return line;
+}
+
+/**
+ * @brief Parses a Linux cpu list such as "2-5,8" into its cpu numbers
+ */
+inline std::vector<int> ParseCpuList(const std::string& list)
+{
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string item;
+  while(std::getline(ss, item, ','))
+  {
+    if(item.empty())
+    {
+      continue;
+    }
+    std::string::size_type dash = item.find('-');
+    int first = std::atoi(item.substr(0, dash).c_str());
+    int last = (dash == std::string::npos) ? first : std::atoi(item.substr(dash + 1).c_str());
+    for(int cpu = first; cpu <= last; cpu++)
+    {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+inline std::string CpuListToString(const std::vector<int>& cpus)
+{
+  std::stringstream ss;
+  for(size_t i = 0; i < cpus.size(); i++)
+  {
+    ss << (i > 0 ? "," : "") << cpus[i];
+  }
+  return ss.str();
+}
+
+/**
+ * @brief Returns the turbo/boost state of the machine ("on", "off" or "unknown")
+ */
+inline std::string ReadTurboState()
+{
+  std::string noTurbo = ReadFirstLine("/sys/devices/system/cpu/intel_pstate/no_turbo");
+  if(!noTurbo.empty())
+  {
+    return noTurbo == "1" ? "off" : "on";
+  }
+  std::string boost = ReadFirstLine("/sys/devices/system/cpu/cpufreq/boost");
+  if(!boost.empty())
+  {
+    return boost == "1" ? "on" : "off";
+  }
+  return "unknown";
+}
+
+/**
+ * @brief Returns the file name of the library that malloc() resolves to, e.g.
+ * "libc.so.6", or "libtbbmalloc_proxy.so.2" when the scalable allocator was
+ * linked or preloaded (SCALABLE_ALLOCATOR of AddSIMPLUnitTest).
+ */
+inline std::string ReadAllocator()
+{
+#if defined(__linux__)
+  Dl_info info;
+  void* address = ::dlsym(RTLD_DEFAULT, "malloc");
+  if(nullptr != address && ::dladdr(address, &info) != 0 && nullptr != info.dli_fname)
+  {
+    std::string name(info.dli_fname);
+    return name.substr(name.find_last_of('/') + 1);
+  }
+#endif
+  return "unknown";
+}
+
+/**
+ * @brief Returns the size in bytes of the largest cache reported for cpu0
+ */
+inline size_t ReadLastLevelCacheSize()
+{
+  size_t largest = 0;
+  for(int index = 0; index < 8; index++)
+  {
+    std::string size = ReadFirstLine("/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/size");
+    if(size.empty())
+    {
+      continue;
+    }
+    size_t value = std::strtoul(size.c_str(), nullptr, 10);
+    char unit = size[size.size() - 1];
+    if(unit == 'K')
+    {
+      value *= 1024;
+    }
+    else if(unit == 'M')
+    {
+      value *= 1024 * 1024;
+    }
+    largest = std::max(largest, value);
+  }
+  return largest;
+}
+
+/**
+ * @brief Restricts the calling thread (and every thread it creates afterwards,
+ * which includes the TBB worker threads) to the given cpus.
+ */
+inline bool PinCurrentThread(const std::vector<int>& cpus)
+{
+#if defined(__linux__)
+  if(cpus.empty())
+  {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for(int cpu : cpus)
+  {
+    CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+/**
+ * @brief Evicts the last level cache by streaming through a buffer twice its size
+ */
+inline void FlushLastLevelCache()
+{
+  static std::vector<uint8_t> buffer;
+  size_t size = std::max<size_t>(GetBenchmarkOptions().LastLevelCacheSize, 8 * 1024 * 1024) * 2;
+  if(buffer.size() != size)
+  {
+    buffer.assign(size, 0);
+  }
+  volatile uint8_t sink = 0;
+  for(size_t i = 0; i < size; i += 64)
+  {
+    buffer[i]++;
+    sink ^= buffer[i];
+  }
+  (void)sink;
+}
+
+/**
+ * @brief Sets up the "--bench-stable" environment: pins the process to the
+ * selected cores and records the scaling governor and turbo state of those cores.
+ */
+inline void ConfigureStableMode()
+{
+  BenchmarkOptions& options = GetBenchmarkOptions();
+  if(options.Cpus.empty())
+  {
+    options.Cpus = ParseCpuList(ReadFirstLine("/sys/devices/system/cpu/isolated"));
+  }
+  if(options.Cpus.empty())
+  {
+    options.Warnings.push_back("No isolated cores (isolcpus) found; pick cores with --bench-cpus=");
+#if defined(__linux__)
+    long numCpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if(numCpus > 0)
+    {
+      options.Cpus.push_back(static_cast<int>(numCpus - 1));
+    }
+#endif
+  }
+  if(!PinCurrentThread(options.Cpus))
+  {
+    options.Warnings.push_back("Could not pin the benchmark threads to cpus '" + CpuListToString(options.Cpus) + "'");
+  }
+
+  for(int cpu : options.Cpus)
+  {
+    std::string governor = ReadFirstLine("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/scaling_governor");
+    if(governor.empty())
+    {
+      governor = "unknown";
+    }
+    options.Governors.push_back(std::to_string(cpu) + ":" + governor);
+    if(governor != "performance")
+    {
+      options.Warnings.push_back("Scaling governor of cpu " + std::to_string(cpu) + " is '" + governor + "' instead of 'performance'");
+    }
+  }
+  options.TurboState = ReadTurboState();
+  if(options.TurboState == "on")
+  {
+    options.Warnings.push_back("Turbo boost is enabled; clock speed will vary with load and temperature");
+  }
+
+  for(const std::string& warning : options.Warnings)
+  {
+    std::cout << "[bench-stable] WARNING: " << warning << "\n";
+  }
+  std::cout << "[bench-stable] cpus=" << CpuListToString(options.Cpus) << " turbo=" << options.TurboState << " cold_cache=" << (options.ColdCache ? "yes" : "no") << std::endl;
+}
+
+/**
+ * @brief Reads the whole machine calibration file. Returns an empty string if the
+ * file can not be read.
+ */
+inline std::string ReadCalibration(const std::string& filePath)
+{
+  std::ifstream in(filePath.c_str());
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::string json = ss.str();
+  while(!json.empty() && (json.back() == '\n' || json.back() == '\r' || json.back() == ' '))
+  {
+    json.pop_back();
+  }
+  return (!json.empty() && json.front() == '{' && json.back() == '}') ? json : std::string();
+}
+
+/**
+ * @brief Looks up a numeric value of the flat calibration JSON object. Returns 0
+ * if the key is not there.
+ */
+inline double CalibrationValue(const std::string& json, const std::string& key)
+{
+  std::string::size_type pos = json.find("\"" + key + "\":");
+  if(pos == std::string::npos)
+  {
+    return 0.0;
+  }
+  return std::strtod(json.c_str() + pos + key.size() + 3, nullptr);
+}
+
+inline double Median(std::vector<double> values)
+{
+  if(values.empty())
+  {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  size_t mid = values.size() / 2;
+  return (values.size() % 2 == 1) ? values[mid] : 0.5 * (values[mid - 1] + values[mid]);
+}
+
+/**
+ * @brief Nearest rank percentile (0-100) of the values
+ */
+inline double Percentile(std::vector<double> values, double percentile)
+{
+  if(values.empty())
+  {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * values.size()));
+  return values[std::min(values.size(), std::max<size_t>(rank, 1)) - 1];
+}
+} // namespace benchmark
+
+// -----------------------------------------------------------------------------
+// NUMA placement of benchmark data. A filter that first-touches its data on the
+// wrong node of a multi socket machine runs much slower than one that does not,
+// so the benchmarks can place their inputs explicitly and report where the pages
+// of those inputs and of the whole process actually ended up.
+// -----------------------------------------------------------------------------
+namespace numa
+{
+enum class Policy
+{
+  Default,    // First touch, the pages end up on the node of the thread that writes them first
+  Local,      // The node of the allocating thread
+  Interleave, // Round robin over all nodes
+  Bind        // A single node
+};
+
+struct Placement
+{
+  Policy Mode = Policy::Default;
+  int Node = 0;
+};
+
+/**
+ * @brief Parses "default", "local", "interleave" or "node:N"
+ */
+inline Placement ParsePlacement(const std::string& text)
+{
+  Placement placement;
+  if(text == "local")
+  {
+    placement.Mode = Policy::Local;
+  }
+  else if(text == "interleave")
+  {
+    placement.Mode = Policy::Interleave;
+  }
+  else if(text.compare(0, 5, "node:") == 0)
+  {
+    placement.Mode = Policy::Bind;
+    placement.Node = std::atoi(text.substr(5).c_str());
+  }
+  return placement;
+}
+
+/**
+ * @brief True if inputs can be placed on chosen nodes, which needs libnuma
+ */
+inline bool PlacementSupported()
+{
+#if defined(SIMPL_HAVE_LIBNUMA)
+  return numa_available() >= 0;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Number of NUMA nodes the kernel knows about (1 if it does not tell)
+ */
+inline int NodeCount()
+{
+  std::vector<int> nodes = benchmark::ParseCpuList(benchmark::ReadFirstLine("/sys/devices/system/node/possible"));
+  return nodes.empty() ? 1 : nodes.back() + 1;
+}
+
+inline std::vector<int> CpusOfNode(int node)
+{
+  return benchmark::ParseCpuList(benchmark::ReadFirstLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+}
+
+/**
+ * @brief The nodes whose cpus the calling thread may run on
+ */
+inline std::vector<int> NodesOfCurrentThread()
+{
+  std::vector<int> nodes;
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if(sched_getaffinity(0, sizeof(set), &set) == 0)
+  {
+    for(int node = 0; node < NodeCount(); node++)
+    {
+      for(int cpu : CpusOfNode(node))
+      {
+        if(cpu < CPU_SETSIZE && CPU_ISSET(cpu, &set))
+        {
+          nodes.push_back(node);
+          break;
+        }
+      }
+    }
+  }
+#endif
+  if(nodes.empty())
+  {
+    nodes.push_back(0);
+  }
+  return nodes;
+}
+
+/**
+ * @brief Allocates 'bytes' with the given placement. The memory has to be
+ * released with Free(). Without libnuma the placement is ignored.
+ */
+inline void* Allocate(size_t bytes, const Placement& placement)
+{
+#if defined(SIMPL_HAVE_LIBNUMA)
+  if(PlacementSupported())
+  {
+    switch(placement.Mode)
+    {
+    case Policy::Local:
+      return numa_alloc_local(bytes);
+    case Policy::Interleave:
+      return numa_alloc_interleaved(bytes);
+    case Policy::Bind:
+      return numa_alloc_onnode(bytes, placement.Node);
+    default:
+      return numa_alloc(bytes);
+    }
+  }
+#endif
+  (void)placement;
+#if defined(__linux__)
+  // The same page aligned anonymous mapping libnuma hands out, so Free() does not need to know who allocated
+  void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return data == MAP_FAILED ? nullptr : data;
+#else
+  return ::malloc(bytes);
+#endif
+}
+
+inline void Free(void* data, size_t bytes)
+{
+  if(nullptr == data)
+  {
+    return;
+  }
+#if defined(__linux__)
+  munmap(data, bytes);
+#else
+  (void)bytes;
+  ::free(data);
+#endif
+}
+
+/**
+ * @brief The benchmark inputs that are alive right now, see Array
+ */
+inline std::vector<std::pair<const void*, size_t>>& Inputs()
+{
+  static std::vector<std::pair<const void*, size_t>> inputs;
+  return inputs;
+}
+
+inline std::mutex& InputsMutex()
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+/**
+ * @brief A fixed size array of benchmark input data that lives on the nodes
+ * given by its placement (by default the one selected with --bench-numa=). All
+ * pages are written once by the constructor, so they are placed before the
+ * first timed run. While the array is alive the benchmark reports include where
+ * its pages are and how much of it is remote to the benchmark threads.
+ */
+template <typename T>
+class Array
+{
+  static_assert(std::is_trivial<T>::value, "numa::Array holds plain data only");
+
+public:
+  explicit Array(size_t count)
+  : Array(count, ParsePlacement(GetBenchmarkOptions().NumaPlacement))
+  {
+  }
+
+  Array(size_t count, const Placement& placement)
+  : m_Size(count)
+  , m_Bytes(std::max<size_t>(count * sizeof(T), 1))
+  , m_Data(static_cast<T*>(Allocate(m_Bytes, placement)))
+  {
+    if(nullptr == m_Data)
+    {
+      throw std::bad_alloc();
+    }
+    ::memset(m_Data, 0, m_Bytes);
+    std::lock_guard<std::mutex> lock(InputsMutex());
+    Inputs().push_back(std::make_pair(static_cast<const void*>(m_Data), m_Bytes));
+  }
+
+  ~Array()
+  {
+    {
+      std::lock_guard<std::mutex> lock(InputsMutex());
+      std::vector<std::pair<const void*, size_t>>& inputs = Inputs();
+      for(size_t i = 0; i < inputs.size(); i++)
+      {
+        if(inputs[i].first == m_Data)
+        {
+          inputs.erase(inputs.begin() + i);
+          break;
+        }
+      }
+    }
+    Free(m_Data, m_Bytes);
+  }
+
+  Array(const Array&) = delete;
+  Array& operator=(const Array&) = delete;
+
+  T* data()
+  {
+    return m_Data;
+  }
+  const T* data() const
+  {
+    return m_Data;
+  }
+  size_t size() const
+  {
+    return m_Size;
+  }
+  T& operator[](size_t i)
+  {
+    return m_Data[i];
+  }
+  const T& operator[](size_t i) const
+  {
+    return m_Data[i];
+  }
+  T* begin()
+  {
+    return m_Data;
+  }
+  T* end()
+  {
+    return m_Data + m_Size;
+  }
+
+private:
+  size_t m_Size;
+  size_t m_Bytes;
+  T* m_Data;
+};
+
+/**
+ * @brief Bytes of the given range that reside on each node. At most 4096 pages
+ * are looked up, spread evenly over the range. Returns an empty vector if the
+ * kernel can not be asked, which needs libnuma.
+ */
+inline std::vector<double> RangePlacement(const void* data, size_t bytes)
+{
+  std::vector<double> perNode;
+#if defined(SIMPL_HAVE_LIBNUMA)
+  if(!PlacementSupported() || bytes == 0)
+  {
+    return perNode;
+  }
+  const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+  const uintptr_t first = reinterpret_cast<uintptr_t>(data) & ~(pageSize - 1);
+  const size_t numPages = static_cast<size_t>((reinterpret_cast<uintptr_t>(data) + bytes - first + pageSize - 1) / pageSize);
+  const size_t step = std::max<size_t>(1, numPages / 4096);
+  std::vector<void*> pages;
+  for(size_t i = 0; i < numPages; i += step)
+  {
+    pages.push_back(reinterpret_cast<void*>(first + i * pageSize));
+  }
+  // Without target nodes move_pages() only reports the node of every page
+  std::vector<int> status(pages.size(), -1);
+  if(numa_move_pages(0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0)
+  {
+    return perNode;
+  }
+  perNode.assign(NodeCount(), 0.0);
+  const double bytesPerSample = static_cast<double>(bytes) / pages.size();
+  for(int node : status)
+  {
+    if(node >= 0 && node < static_cast<int>(perNode.size()))
+    {
+      perNode[node] += bytesPerSample;
+    }
+  }
+#else
+  (void)data;
+  (void)bytes;
+#endif
+  return perNode;
+}
+
+/**
+ * @brief Resident bytes of the whole process on each node, from /proc/self/numa_maps
+ */
+inline std::vector<double> ProcessPlacement()
+{
+  std::vector<double> perNode;
+  std::ifstream in("/proc/self/numa_maps");
+  std::string line;
+  while(std::getline(in, line))
+  {
+    std::stringstream ss(line);
+    std::string token;
+    double pageBytes = 4096.0;
+    std::vector<std::pair<int, double>> pages;
+    while(ss >> token)
+    {
+      if(token.compare(0, 18, "kernelpagesize_kB=") == 0)
+      {
+        pageBytes = std::atof(token.c_str() + 18) * 1024.0;
+      }
+      else if(token.size() > 2 && token[0] == 'N' && token[1] >= '0' && token[1] <= '9')
+      {
+        std::string::size_type eq = token.find('=');
+        if(eq != std::string::npos)
+        {
+          pages.push_back(std::make_pair(std::atoi(token.c_str() + 1), std::atof(token.c_str() + eq + 1)));
+        }
+      }
+    }
+    for(const std::pair<int, double>& entry : pages)
+    {
+      if(entry.first >= static_cast<int>(perNode.size()))
+      {
+        perNode.resize(entry.first + 1, 0.0);
+      }
+      perNode[entry.first] += entry.second * pageBytes;
+    }
+  }
+  return perNode;
+}
+
+/**
+ * @brief Sum of one counter of /sys/devices/system/node/nodeN/numastat over all
+ * nodes. These are system wide page allocation counters, e.g. "other_node"
+ * counts pages that were allocated on a node other than the one the allocating
+ * thread ran on.
+ */
+inline double ReadNumaStat(const std::string& key)
+{
+  double total = 0.0;
+  for(int node = 0; node < NodeCount(); node++)
+  {
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/numastat");
+    std::string name;
+    double value = 0.0;
+    while(in >> name >> value)
+    {
+      if(name == key)
+      {
+        total += value;
+      }
+    }
+  }
+  return total;
+}
+
+inline std::string FormatPerNode(const std::vector<double>& perNode)
+{
+  std::stringstream ss;
+  ss << std::fixed << std::setprecision(1);
+  for(size_t node = 0; node < perNode.size(); node++)
+  {
+    ss << (node > 0 ? ", " : "") << "node" << node << " " << perNode[node] / (1024.0 * 1024.0) << " MB";
+  }
+  return ss.str();
+}
+
+/**
+ * @brief Reports where the live benchmark inputs and the process memory are,
+ * which part of the inputs is remote to the nodes the benchmark runs on and,
+ * if the bytes a run moves are known, the estimated cross-node traffic of one
+ * run. The numbers go to std::cout and into 'record'.
+ */
+inline void ReportPlacement(const BenchmarkWork& work, double otherNodeBefore, BenchmarkRecord& record)
+{
+  const BenchmarkOptions& options = GetBenchmarkOptions();
+  std::vector<int> cpuNodes = NodesOfCurrentThread();
+  std::vector<double> inputs;
+  double inputBytes = 0.0;
+  {
+    std::lock_guard<std::mutex> lock(InputsMutex());
+    for(const std::pair<const void*, size_t>& input : Inputs())
+    {
+      std::vector<double> perNode = RangePlacement(input.first, input.second);
+      inputs.resize(std::max(inputs.size(), perNode.size()), 0.0);
+      for(size_t node = 0; node < perNode.size(); node++)
+      {
+        inputs[node] += perNode[node];
+        inputBytes += perNode[node];
+      }
+    }
+  }
+  double remoteBytes = 0.0;
+  for(size_t node = 0; node < inputs.size(); node++)
+  {
+    if(std::find(cpuNodes.begin(), cpuNodes.end(), static_cast<int>(node)) == cpuNodes.end())
+    {
+      remoteBytes += inputs[node];
+    }
+  }
+  double remoteFraction = inputBytes > 0.0 ? remoteBytes / inputBytes : 0.0;
+  std::vector<double> process = ProcessPlacement();
+
+  record.add("nodes", static_cast<int64_t>(NodeCount()));
+  record.add("cpu_nodes", benchmark::CpuListToString(cpuNodes));
+  record.add("placement", options.NumaPlacement);
+  record.add("input_bytes_per_node", inputs);
+  record.add("input_remote_fraction", remoteFraction);
+  record.add("process_bytes_per_node", process);
+  record.add("other_node_allocations", ReadNumaStat("other_node") - otherNodeBefore);
+  if(work.Bytes > 0.0 && inputBytes > 0.0)
+  {
+    record.add("cross_node_bytes_estimate", work.Bytes * remoteFraction);
+  }
+
+  // Single node machines have nothing to report unless inputs were placed explicitly
+  if(NodeCount() < 2 && inputs.empty())
+  {
+    return;
+  }
+  std::cout << "    NUMA: running on node(s) " << benchmark::CpuListToString(cpuNodes);
+  if(!inputs.empty())
+  {
+    std::cout << ", inputs " << FormatPerNode(inputs) << " (" << remoteFraction * 100.0 << "% remote";
+    if(work.Bytes > 0.0)
+    {
+      std::cout << ", ~" << work.Bytes * remoteFraction / (1024.0 * 1024.0) << " MB cross-node per run";
+    }
+    std::cout << ")";
+  }
+  std::cout << ", process " << FormatPerNode(process) << "\n";
+}
+} // namespace numa
+
+namespace energy
+{
+// -----------------------------------------------------------------------------
+// Energy of the benchmark runs from the RAPL counters of the Linux powercap
+// interface (Intel, and AMD Zen with Linux 5.8 or newer). The counters cover
+// whole packages, so everything else that runs on the machine is included.
+// -----------------------------------------------------------------------------
+struct Zone
+{
+  std::string Name;         // package-0, core, uncore, dram or psys
+  std::string Label;        // The name with the package of a sub zone, e.g. package-1/dram
+  std::string EnergyFile;   // .../energy_uj, a wrapping microjoule counter
+  uint64_t MaxRange = 0;    // The counter wraps to 0 after this value
+  bool InTotal = false;     // The packages and the dram; core/uncore are part of their package and psys of the platform
+};
+
+struct Counters
+{
+  std::vector<Zone> Zones;
+  std::string Unavailable; // Why there are no zones, reported instead of the energy
+};
+
+inline bool ReadCounter(const std::string& filePath, uint64_t& value)
+{
+  std::string line = benchmark::ReadFirstLine(filePath);
+  if(line.empty())
+  {
+    return false;
+  }
+  value = std::strtoull(line.c_str(), nullptr, 10);
+  return true;
+}
+
+/**
+ * @brief Finds the RAPL zones once. Their names are readable by everyone,
+ * energy_uj only by root since Linux 5.10 (CVE-2020-8694).
+ */
+inline const Counters& GetCounters()
+{
+  static Counters counters;
+  static bool initialized = false;
+  if(initialized)
+  {
+    return counters;
+  }
+  initialized = true;
+#if defined(__linux__)
+  bool found = false;
+  for(int package = 0; package < 64; package++)
+  {
+    std::string top = "/sys/class/powercap/intel-rapl:" + std::to_string(package);
+    if(benchmark::ReadFirstLine(top + "/name").empty())
+    {
+      break;
+    }
+    std::string packageName = benchmark::ReadFirstLine(top + "/name");
+    for(int sub = -1; sub < 16; sub++)
+    {
+      std::string dir = sub < 0 ? top : top + ":" + std::to_string(sub);
+      Zone zone;
+      zone.Name = benchmark::ReadFirstLine(dir + "/name");
+      if(zone.Name.empty())
+      {
+        break;
+      }
+      found = true;
+      zone.Label = sub < 0 ? zone.Name : packageName + "/" + zone.Name;
+      zone.EnergyFile = dir + "/energy_uj";
+      uint64_t value = 0;
+      if(!ReadCounter(zone.EnergyFile, value) || !ReadCounter(dir + "/max_energy_range_uj", zone.MaxRange))
+      {
+        continue;
+      }
+      zone.InTotal = zone.Name == "dram" || (sub < 0 && zone.Name != "psys");
+      counters.Zones.push_back(zone);
+    }
+  }
+  if(!found)
+  {
+    counters.Unavailable = "No RAPL counters in /sys/class/powercap (needs the intel_rapl driver on bare metal)";
+  }
+  else if(counters.Zones.empty())
+  {
+    counters.Unavailable = "The RAPL counters in /sys/class/powercap/intel-rapl:*/energy_uj are only readable by root";
+  }
+#else
+  counters.Unavailable = "RAPL energy counters are only read on Linux";
+#endif
+  return counters;
+}
+
+/**
+ * @brief Accumulates the energy of each zone over several samples. Sampling
+ * between the runs keeps the wraparound of the counters (every few minutes on
+ * a loaded server) handled as long as a single run is shorter than that.
+ */
+class Meter
+{
+public:
+  Meter()
+  : m_Zones(GetCounters().Zones)
+  , m_Last(m_Zones.size(), 0)
+  , m_Joules(m_Zones.size(), 0.0)
+  {
+    restart();
+  }
+
+  bool available() const
+  {
+    return !m_Zones.empty();
+  }
+
+  /**
+   * @brief Drops the energy used since the last sample
+   */
+  void restart()
+  {
+    for(size_t i = 0; i < m_Zones.size(); i++)
+    {
+      ReadCounter(m_Zones[i].EnergyFile, m_Last[i]);
+    }
+  }
+
+  void sample()
+  {
+    for(size_t i = 0; i < m_Zones.size(); i++)
+    {
+      uint64_t value = 0;
+      if(!ReadCounter(m_Zones[i].EnergyFile, value))
+      {
+        continue;
+      }
+      uint64_t delta = value >= m_Last[i] ? value - m_Last[i] : m_Zones[i].MaxRange - m_Last[i] + value + 1;
+      m_Joules[i] += static_cast<double>(delta) * 1.0e-6;
+      m_Last[i] = value;
+    }
+  }
+
+  double total() const
+  {
+    double joules = 0.0;
+    for(size_t i = 0; i < m_Zones.size(); i++)
+    {
+      joules += m_Zones[i].InTotal ? m_Joules[i] : 0.0;
+    }
+    return joules;
+  }
+
+  /**
+   * @brief Prints the energy of one run and adds it to 'record'
+   */
+  void report(int iterations, double seconds, const BenchmarkWork& work, BenchmarkRecord& record) const
+  {
+    if(!available())
+    {
+      record.add("available", false);
+      record.add("reason", GetCounters().Unavailable);
+      return;
+    }
+    double perRun = total() / iterations;
+    record.add("available", true);
+    record.add("joules_per_run", perRun);
+    record.add("watts", seconds > 0.0 ? total() / seconds : 0.0);
+    std::cout << "    Energy " << perRun << " J per run, " << (seconds > 0.0 ? total() / seconds : 0.0) << " W";
+    if(work.Elements > 0.0)
+    {
+      record.add("joules_per_element", perRun / work.Elements);
+      std::cout << ", " << perRun / work.Elements * 1.0e9 << " nJ per element";
+    }
+    std::cout << " (";
+    BenchmarkRecord zones;
+    for(size_t i = 0; i < m_Zones.size(); i++)
+    {
+      zones.add(m_Zones[i].Label, m_Joules[i] / iterations);
+      std::cout << (i > 0 ? ", " : "") << m_Zones[i].Label << " " << m_Joules[i] / iterations << " J";
+    }
+    record.addRaw("zones_joules_per_run", zones.toJson());
+    std::cout << ")\n";
+  }
+
+private:
+  std::vector<Zone> m_Zones;
+  std::vector<uint64_t> m_Last;
+  std::vector<double> m_Joules;
+};
+} // namespace energy
+
+// -----------------------------------------------------------------------------
+//
+// -----------------------------------------------------------------------------
+/**
+ * @brief Parses the benchmark related arguments of the test executable. Unknown
+ * arguments are ignored so this can be handed the complete argument list.
+ */
+inline void ParseBenchmarkArguments(int argc, char** argv)
+{
+  BenchmarkOptions& options = GetBenchmarkOptions();
+  options.Allocator = benchmark::ReadAllocator();
+  const char* env = ::getenv("SIMPL_BENCHMARK_RESULTS");
+  if(nullptr != env)
+  {
+    options.ResultsFile = env;
+  }
+  // The calibration that was measured when the project was configured, see CMP_MACHINE_CALIBRATION
+  std::string calibrationFile;
+#if defined(SIMPL_MACHINE_CALIBRATION_FILE)
+  calibrationFile = SIMPL_MACHINE_CALIBRATION_FILE;
+#endif
+  env = ::getenv("SIMPL_MACHINE_CALIBRATION");
+  if(nullptr != env)
+  {
+    calibrationFile = env;
+  }
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if(arg == "--bench-stable")
+    {
+      options.Stable = true;
+    }
+    else if(arg == "--bench-cold-cache")
+    {
+      options.ColdCache = true;
+    }
+    else if(arg.compare(0, 13, "--bench-cpus=") == 0)
+    {
+      options.Cpus = benchmark::ParseCpuList(arg.substr(13));
+    }
+    else if(arg.compare(0, 19, "--bench-iterations=") == 0)
+    {
+      options.Iterations = std::atoi(arg.substr(19).c_str());
+    }
+    else if(arg.compare(0, 16, "--bench-results=") == 0)
+    {
+      options.ResultsFile = arg.substr(16);
+    }
+    else if(arg.compare(0, 20, "--bench-calibration=") == 0)
+    {
+      calibrationFile = arg.substr(20);
+    }
+    else if(arg.compare(0, 13, "--bench-numa=") == 0)
+    {
+      options.NumaPlacement = arg.substr(13);
+    }
+    else if(arg.compare(0, 22, "--bench-numa-cpu-node=") == 0)
+    {
+      options.NumaCpuNode = std::atoi(arg.substr(22).c_str());
+    }
+  }
+  if(!calibrationFile.empty())
+  {
+    options.MachineCalibration = benchmark::ReadCalibration(calibrationFile);
+    if(options.MachineCalibration.empty())
+    {
+      std::cout << "WARNING: Could not read the machine calibration from '" << calibrationFile << "'\n";
+    }
+  }
+  options.LastLevelCacheSize = benchmark::ReadLastLevelCacheSize();
+  if(options.NumaPlacement != "default" && !numa::PlacementSupported())
+  {
+    options.Warnings.push_back("--bench-numa=" + options.NumaPlacement + " needs libnuma (CMP_HAVE_LIBNUMA); inputs use the default placement");
+    std::cout << "WARNING: " << options.Warnings.back() << "\n";
+  }
+  if(options.NumaCpuNode >= 0)
+  {
+    // Run on one node, so inputs placed on another node are remote to the benchmark
+    std::vector<int> cpus = numa::CpusOfNode(options.NumaCpuNode);
+    if(cpus.empty())
+    {
+      options.Warnings.push_back("NUMA node " + std::to_string(options.NumaCpuNode) + " has no cpus");
+      std::cout << "WARNING: " << options.Warnings.back() << "\n";
+    }
+    else
+    {
+      // With --bench-cpus= as well only its cpus on the node are used
+      std::vector<int> nodeCpus = cpus;
+      if(!options.Cpus.empty())
+      {
+        cpus.clear();
+        for(int cpu : options.Cpus)
+        {
+          if(std::find(nodeCpus.begin(), nodeCpus.end(), cpu) != nodeCpus.end())
+          {
+            cpus.push_back(cpu);
+          }
+        }
+      }
+      if(cpus.empty())
+      {
+        options.Warnings.push_back("None of the cpus '" + benchmark::CpuListToString(options.Cpus) + "' of --bench-cpus= is on NUMA node " + std::to_string(options.NumaCpuNode) +
+                                   " (cpus '" + benchmark::CpuListToString(nodeCpus) + "'), --bench-numa-cpu-node= is ignored");
+        std::cout << "WARNING: " << options.Warnings.back() << "\n";
+      }
+      else if(options.Stable)
+      {
+        options.Cpus = cpus;
+        std::cout << "Benchmarks run on cpus '" << benchmark::CpuListToString(cpus) << "' of NUMA node " << options.NumaCpuNode << "\n";
+      }
+      else if(!benchmark::PinCurrentThread(cpus))
+      {
+        options.Warnings.push_back("Could not run on the cpus '" + benchmark::CpuListToString(cpus) + "' of NUMA node " + std::to_string(options.NumaCpuNode));
+        std::cout << "WARNING: " << options.Warnings.back() << "\n";
+      }
+      else
+      {
+        options.Cpus = cpus;
+        std::cout << "Benchmarks run on cpus '" << benchmark::CpuListToString(cpus) << "' of NUMA node " << options.NumaCpuNode << "\n";
+      }
+    }
+  }
+  if(options.Stable)
+  {
+    benchmark::ConfigureStableMode();
+  }
+}
+
+/**
+ * @brief Times 'iterations' runs of 'fn' and reports the statistics to std::cout
+ * and, when a results file was given, appends them as a JSON line to that file
+ * together with the conditions the benchmark ran under and the calibration of the
+ * machine. If 'work' is given the achieved bandwidth and FLOP rate are reported as
+ * fractions of the calibrated peaks, together with the roofline bound.
+ */
+inline void RunBenchmark(const std::string& name, const std::function<void()>& fn, int iterations, const BenchmarkWork& work = BenchmarkWork())
+{
+  BenchmarkOptions& options = GetBenchmarkOptions();
+  if(options.Iterations > 0)
+  {
+    iterations = options.Iterations;
+  }
+  iterations = std::max(1, iterations);
+
+  std::string turboBefore = options.Stable ? benchmark::ReadTurboState() : options.TurboState;
+  double otherNodeBefore = numa::ReadNumaStat("other_node");
+  if(!options.ColdCache)
+  {
+    fn(); // Warm up the caches and any lazily initialized state
+  }
+#if defined(SIMPL_HAVE_LATENCY_HISTOGRAM)
+  BenchmarkLatencies().reset();
+#endif
+
+  // Once for the executable and only when it runs a benchmark at all
+  static bool energyNoteShown = false;
+  if(!energyNoteShown && !energy::GetCounters().Unavailable.empty())
+  {
+    energyNoteShown = true;
+    std::cout << "Benchmark energy is not measured: " << energy::GetCounters().Unavailable << "\n";
+  }
+
+  std::vector<double> seconds;
+  seconds.reserve(iterations);
+  energy::Meter energyMeter;
+  for(int i = 0; i < iterations; i++)
+  {
+    if(options.ColdCache)
+    {
+      benchmark::FlushLastLevelCache();
+      energyMeter.restart(); // The flush is not part of the run
+    }
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto stop = std::chrono::steady_clock::now();
+    energyMeter.sample();
+    seconds.push_back(std::chrono::duration<double>(stop - start).count());
+  }
+
+  std::vector<std::string> warnings = options.Warnings;
+  if(options.Stable)
+  {
+    std::string turboAfter = benchmark::ReadTurboState();
+    if(turboAfter != turboBefore)
+    {
+      warnings.push_back("Turbo state changed from '" + turboBefore + "' to '" + turboAfter + "' during the benchmark");
+      std::cout << "[bench-stable] WARNING: " << warnings.back() << "\n";
+    }
+  }
+
+  double mean = 0.0;
+  for(double s : seconds)
+  {
+    mean += s;
+  }
+  mean /= seconds.size();
+  double variance = 0.0;
+  for(double s : seconds)
+  {
+    variance += (s - mean) * (s - mean);
+  }
+  double stddev = std::sqrt(variance / seconds.size());
+  double median = benchmark::Median(seconds);
+  double minimum = *std::min_element(seconds.begin(), seconds.end());
+  double maximum = *std::max_element(seconds.begin(), seconds.end());
+  double p99 = benchmark::Percentile(seconds, 99.0);
+
+  std::cout << "  Benchmark " << name << ": median " << median * 1000.0 << " ms, min " << minimum * 1000.0 << " ms, mean " << mean * 1000.0 << " ms, stddev " << stddev * 1000.0 << " ms, p99 "
+            << p99 * 1000.0 << " ms, max " << maximum * 1000.0 << " ms (" << iterations << " iterations)\n";
+  if(work.Elements > 0.0)
+  {
+    std::cout << "    " << median / work.Elements * 1.0e9 << " ns per element (" << work.Elements << " elements)\n";
+  }
+#if defined(SIMPL_HAVE_LATENCY_HISTOGRAM)
+  const cmp::LatencyHistogram& latencies = BenchmarkLatencies();
+  if(latencies.count() > 0)
+  {
+    std::cout << "    Operation latency " << latencies.summary() << "\n";
+  }
+#endif
+
+  // Relate the achieved rates to what this machine can do at best
+  BenchmarkRecord roofline;
+  if(median > 0.0 && (work.Bytes > 0.0 || work.Flops > 0.0))
+  {
+    const std::string& machine = options.MachineCalibration;
+    double peakBandwidth = benchmark::CalibrationValue(machine, "stream_triad_all_threads_gbs");
+    // SMT siblings share the floating point units of their core, so only physical cores add to the peak
+    double cores = benchmark::CalibrationValue(machine, "physical_cores");
+    if(cores <= 0.0)
+    {
+      cores = benchmark::CalibrationValue(machine, "hardware_threads"); // Calibrated before physical_cores was measured
+    }
+    double peakFlops = benchmark::CalibrationValue(machine, "peak_gflops_single_core") * cores;
+    double bandwidth = work.Bytes / median / 1.0e9;
+    double flops = work.Flops / median / 1.0e9;
+    std::cout << "    " << bandwidth << " GB/s, " << flops << " GFLOP/s";
+    roofline.add("gbs", bandwidth);
+    roofline.add("gflops", flops);
+    if(peakBandwidth > 0.0 && peakFlops > 0.0)
+    {
+      double bandwidthFraction = bandwidth / peakBandwidth;
+      double computeFraction = flops / peakFlops;
+      roofline.add("bandwidth_fraction", bandwidthFraction);
+      roofline.add("compute_fraction", computeFraction);
+      std::cout << " (" << bandwidthFraction * 100.0 << "% of peak bandwidth, " << computeFraction * 100.0 << "% of peak FLOP rate";
+      if(work.Bytes > 0.0 && work.Flops > 0.0)
+      {
+        double intensity = work.Flops / work.Bytes;
+        double attainable = std::min(peakFlops, intensity * peakBandwidth);
+        roofline.add("arithmetic_intensity", intensity);
+        roofline.add("roofline_gflops", attainable);
+        roofline.add("bound", intensity * peakBandwidth < peakFlops ? "memory" : "compute");
+        std::cout << ", " << (intensity * peakBandwidth < peakFlops ? "memory" : "compute") << " bound at " << flops / attainable * 100.0 << "% of the roofline";
+      }
+      std::cout << ")";
+    }
+    std::cout << "\n";
+  }
+  BenchmarkRecord numaRecord;
+  numa::ReportPlacement(work, otherNodeBefore, numaRecord);
+  BenchmarkRecord energyRecord;
+  energyMeter.report(iterations, mean * seconds.size(), work, energyRecord);
+
+  if(options.ResultsFile.empty())
+  {
+    return;
+  }
+  BenchmarkRecord record;
+  record.add("benchmark", name);
+  record.add("iterations", static_cast<int64_t>(iterations));
+  record.add("median_s", median);
+  record.add("min_s", minimum);
+  record.add("mean_s", mean);
+  record.add("stddev_s", stddev);
+  record.add("p99_s", p99);
+  record.add("max_s", maximum);
+#if defined(SIMPL_HAVE_LATENCY_HISTOGRAM)
+  if(latencies.count() > 0)
+  {
+    record.addRaw("latency", latencies.toJson());
+  }
+#endif
+  record.add("stable", options.Stable);
+  record.add("cold_cache", options.ColdCache);
+  record.add("cpus", benchmark::CpuListToString(options.Cpus));
+  record.add("governors", options.Governors);
+  record.add("turbo", turboBefore);
+  record.add("allocator", options.Allocator);
+  record.add("warnings", warnings);
+  if(work.Bytes > 0.0 || work.Flops > 0.0)
+  {
+    record.add("bytes", work.Bytes);
+    record.add("flops", work.Flops);
+    record.addRaw("roofline", roofline.toJson());
+  }
+  record.addRaw("numa", numaRecord.toJson());
+  if(work.Elements > 0.0)
+  {
+    record.add("elements", work.Elements);
+    record.add("median_s_per_element", median / work.Elements);
+  }
+  record.addRaw("energy", energyRecord.toJson());
+  if(!options.MachineCalibration.empty())
+  {
+    record.addRaw("machine", options.MachineCalibration);
+  }
+
+  std::ofstream out(options.ResultsFile.c_str(), std::ios::app);
+  out << record.toJson() << "\n";
+}
+} // namespace unittest
+} // namespace SIMPL
+
+// -----------------------------------------------------------------------------
+// Developer Used Macros
+// -----------------------------------------------------------------------------
+#define DREAM3D_REGISTER_BENCHMARK(test, iterations)                                                                                                                                                   \
+  try                                                                                                                                                                                                  \
+  {                                                                                                                                                                                                    \
+    DREAM3D_ENTER_TEST(test);                                                                                                                                                                          \
+    SIMPL::unittest::RunBenchmark(#test, [&]() { test; }, iterations);                                                                                                                                 \
+    DREAM3D_LEAVE_TEST(test)                                                                                                                                                                           \
+  } catch(TestException & e)                                                                                                                                                                           \
+  {                                                                                                                                                                                                    \
+    TestFailed(SIMPL::unittest::CurrentMethod, e);                                                                                                                                                     \
+    std::cout << e.what() << std::endl;                                                                                                                                                                \
+    err = EXIT_FAILURE;                                                                                                                                                                                \
+  }
+
+#define DREAM3D_REGISTER_BENCHMARK_WORK(test, iterations, bytes, flops)                                                                                                                                \
+  DREAM3D_REGISTER_BENCHMARK_ELEMENTS(test, iterations, bytes, flops, 0.0)
+
+// The time and the energy are also reported per element, e.g. per voxel or per feature
+#define DREAM3D_REGISTER_BENCHMARK_ELEMENTS(test, iterations, bytes, flops, elements)                                                                                                                  \
+  try                                                                                                                                                                                                  \
+  {                                                                                                                                                                                                    \
+    DREAM3D_ENTER_TEST(test);                                                                                                                                                                          \
+    SIMPL::unittest::BenchmarkWork benchmarkWork;                                                                                                                                                      \
+    benchmarkWork.Bytes = (bytes);                                                                                                                                                                     \
+    benchmarkWork.Flops = (flops);                                                                                                                                                                     \
+    benchmarkWork.Elements = (elements);                                                                                                                                                               \
+    SIMPL::unittest::RunBenchmark(#test, [&]() { test; }, iterations, benchmarkWork);                                                                                                                  \
+    DREAM3D_LEAVE_TEST(test)                                                                                                                                                                           \
+  } catch(TestException & e)                                                                                                                                                                           \
+  {                                                                                                                                                                                                    \
+    TestFailed(SIMPL::unittest::CurrentMethod, e);                                                                                                                                                     \
+    std::cout << e.what() << std::endl;                                                                                                                                                                \
+    err = EXIT_FAILURE;                                                                                                                                                                                \
+  }
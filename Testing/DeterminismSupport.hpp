@@ -0,0 +1,550 @@
+/* ============================================================================
+* Copyright (c) 2009-2016 BlueQuartz Software, LLC
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* Redistributions in binary form must reproduce the above copyright notice, this
+* list of conditions and the following disclaimer in the documentation and/or
+* other materials provided with the distribution.
+*
+* Neither the name of BlueQuartz Software, the US Air Force, nor the names of its
+* contributors may be used to endorse or promote products derived from this software
+* without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* The code contained herein was partially funded by the followig contracts:
+*    United States Air Force Prime Contract FA8650-07-D-5800
+*    United States Air Force Prime Contract FA8650-10-D-5210
+*    United States Prime Contract Navy N00173-07-C-2068
+*
+* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+//-- C Includes
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-- C++ Includes
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(SIMPL_USE_PARALLEL_ALGORITHMS)
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+#endif
+
+#include "UnitTestSupport.hpp"
+
+namespace SIMPL
+{
+namespace unittest
+{
+// -----------------------------------------------------------------------------
+// Options that are set from the command line of the generated test executable
+// -----------------------------------------------------------------------------
+struct DeterminismOptions
+{
+  std::vector<int> Threads; // --determinism-threads=1,2,8 (default 1, 2 and every hardware thread)
+  int Repeats = 2;          // --determinism-repeats=N, runs of every configuration; work stealing differs between runs
+  int MaxUlps = 0;          // --determinism-ulps=N, 0 requires bit identical floating point outputs
+};
+
+inline DeterminismOptions& GetDeterminismOptions()
+{
+  static DeterminismOptions options;
+  return options;
+}
+
+enum class Partitioner
+{
+  Static, // Equal, contiguous chunks per thread; the reference configuration
+  Simple, // Chunks of exactly the grain size, handed out dynamically
+  Auto,   // TBB's default adaptive splitting (without TBB: dynamic chunks of a few per thread)
+  Affinity
+};
+
+inline const char* PartitionerName(Partitioner partitioner)
+{
+  switch(partitioner)
+  {
+  case Partitioner::Static:
+    return "static";
+  case Partitioner::Simple:
+    return "simple";
+  case Partitioner::Auto:
+    return "auto";
+  case Partitioner::Affinity:
+    return "affinity";
+  }
+  return "";
+}
+
+/**
+ * @brief The outputs of one run of the computation, as raw bytes with a
+ * function that compares two of them element by element.
+ */
+struct DeterminismOutput
+{
+  struct Divergence
+  {
+    size_t Elements = 0;
+    size_t FirstIndex = 0;
+    std::string Reference;
+    std::string Value;
+    uint64_t MaxUlps = 0;
+  };
+  typedef bool (*CompareFunction)(const DeterminismOutput& reference, const DeterminismOutput& output, int maxUlps, Divergence& divergence);
+
+  std::string Name;
+  size_t Count = 0;
+  std::vector<unsigned char> Bytes;
+  uint64_t Hash = 0;
+  CompareFunction Compare = nullptr;
+};
+
+inline uint64_t UlpDistance(double a, double b)
+{
+  int64_t aInt = 0;
+  int64_t bInt = 0;
+  memcpy(&aInt, &a, sizeof(a));
+  memcpy(&bInt, &b, sizeof(b));
+  // Make both lexicographically ordered as twos-complement ints, like AlmostEqualUlpsFinal()
+  if(aInt < 0)
+  {
+    aInt = static_cast<int64_t>(0x8000000000000000ULL - static_cast<uint64_t>(aInt));
+  }
+  if(bInt < 0)
+  {
+    bInt = static_cast<int64_t>(0x8000000000000000ULL - static_cast<uint64_t>(bInt));
+  }
+  return aInt > bInt ? static_cast<uint64_t>(aInt) - static_cast<uint64_t>(bInt) : static_cast<uint64_t>(bInt) - static_cast<uint64_t>(aInt);
+}
+
+inline uint64_t UlpDistance(float a, float b)
+{
+  int32_t aInt = 0;
+  int32_t bInt = 0;
+  memcpy(&aInt, &a, sizeof(a));
+  memcpy(&bInt, &b, sizeof(b));
+  // The same ordering in 32 bits: -0.0f (INT32_MIN) maps to 0 and the negative values below it
+  int64_t aOrdered = aInt < 0 ? static_cast<int64_t>(INT32_MIN) - aInt : aInt;
+  int64_t bOrdered = bInt < 0 ? static_cast<int64_t>(INT32_MIN) - bInt : bInt;
+  return static_cast<uint64_t>(aOrdered > bOrdered ? aOrdered - bOrdered : bOrdered - aOrdered);
+}
+
+inline bool ValuesMatch(float a, float b, int maxUlps, uint64_t& ulps)
+{
+  ulps = UlpDistance(a, b);
+  // AlmostEqualUlpsFinal() rewrites its arguments in place, so hand it copies
+  return AlmostEqualUlpsFinal(&a, &b, maxUlps);
+}
+
+inline bool ValuesMatch(double a, double b, int maxUlps, uint64_t& ulps)
+{
+  ulps = UlpDistance(a, b);
+  return ulps <= static_cast<uint64_t>(maxUlps);
+}
+
+template <typename T>
+bool ValuesMatch(T a, T b, int, uint64_t& ulps)
+{
+  ulps = 0;
+  return a == b;
+}
+
+template <typename T>
+bool CompareDeterminismOutputs(const DeterminismOutput& reference, const DeterminismOutput& output, int maxUlps, DeterminismOutput::Divergence& divergence)
+{
+  divergence = DeterminismOutput::Divergence();
+  if(reference.Count != output.Count)
+  {
+    divergence.Elements = std::max(reference.Count, output.Count);
+    divergence.Reference = std::to_string(reference.Count) + " elements";
+    divergence.Value = std::to_string(output.Count) + " elements";
+    return false;
+  }
+  if(reference.Hash == output.Hash && reference.Bytes == output.Bytes)
+  {
+    return true;
+  }
+  const T* a = reinterpret_cast<const T*>(reference.Bytes.data());
+  const T* b = reinterpret_cast<const T*>(output.Bytes.data());
+  for(size_t i = 0; i < reference.Count; i++)
+  {
+    uint64_t ulps = 0;
+    if(memcmp(a + i, b + i, sizeof(T)) == 0 || ValuesMatch(a[i], b[i], maxUlps, ulps))
+    {
+      continue;
+    }
+    if(divergence.Elements == 0)
+    {
+      std::stringstream ref;
+      std::stringstream val;
+      ref.precision(17);
+      val.precision(17);
+      ref << +a[i];
+      val << +b[i];
+      divergence.FirstIndex = i;
+      divergence.Reference = ref.str();
+      divergence.Value = val.str();
+    }
+    divergence.Elements++;
+    divergence.MaxUlps = std::max(divergence.MaxUlps, ulps);
+  }
+  return divergence.Elements == 0;
+}
+
+/**
+ * @brief Handed to the computation under test. The computation runs its
+ * parallel parts through run() or parallelFor() so they use the thread count and
+ * partitioner of the current configuration, and hands every result to
+ * addOutput(), which compares it against the single thread reference.
+ */
+class DeterminismContext
+{
+public:
+  int threads() const
+  {
+    return m_Threads;
+  }
+  Partitioner partitioner() const
+  {
+    return m_Partitioner;
+  }
+  int repeat() const
+  {
+    return m_Repeat;
+  }
+
+  /**
+   * @brief Runs 'fn', e.g. a filter's execute(), limited to threads() worker
+   * threads. With TBB this is a task_arena of that size, so every parallel
+   * algorithm called inside is limited as well.
+   */
+  template <typename Fn>
+  void run(Fn fn)
+  {
+#if defined(SIMPL_USE_PARALLEL_ALGORITHMS)
+    tbb::task_arena arena(m_Threads);
+    arena.execute(fn);
+#else
+    fn();
+#endif
+  }
+
+  /**
+   * @brief Calls body(chunkBegin, chunkEnd) over [begin, end) in parallel with
+   * the partitioner of the current configuration. 'grain' is the smallest chunk.
+   */
+  template <typename Body>
+  void parallelFor(size_t begin, size_t end, size_t grain, Body body)
+  {
+    grain = std::max<size_t>(1, grain);
+    if(end <= begin)
+    {
+      return;
+    }
+#if defined(SIMPL_USE_PARALLEL_ALGORITHMS)
+    run([&]() {
+      tbb::blocked_range<size_t> range(begin, end, grain);
+      auto rangeBody = [&](const tbb::blocked_range<size_t>& r) { body(r.begin(), r.end()); };
+      switch(m_Partitioner)
+      {
+      case Partitioner::Static:
+        tbb::parallel_for(range, rangeBody, tbb::static_partitioner());
+        break;
+      case Partitioner::Simple:
+        tbb::parallel_for(range, rangeBody, tbb::simple_partitioner());
+        break;
+      case Partitioner::Auto:
+        tbb::parallel_for(range, rangeBody, tbb::auto_partitioner());
+        break;
+      case Partitioner::Affinity:
+        tbb::parallel_for(range, rangeBody, m_AffinityPartitioner);
+        break;
+      }
+    });
+#else
+    const size_t count = end - begin;
+    size_t chunk = grain;
+    if(m_Partitioner == Partitioner::Static)
+    {
+      chunk = std::max(grain, (count + m_Threads - 1) / m_Threads);
+    }
+    else if(m_Partitioner != Partitioner::Simple)
+    {
+      chunk = std::max(grain, count / (static_cast<size_t>(m_Threads) * 4));
+    }
+    std::atomic<size_t> next(begin);
+    auto worker = [&]() {
+      for(size_t b = next.fetch_add(chunk); b < end; b = next.fetch_add(chunk))
+      {
+        body(b, std::min(end, b + chunk));
+      }
+    };
+    std::vector<std::thread> workers;
+    for(int t = 1; t < m_Threads; t++)
+    {
+      workers.emplace_back(worker);
+    }
+    worker();
+    for(std::thread& thread : workers)
+    {
+      thread.join();
+    }
+#endif
+  }
+
+  /**
+   * @brief Records 'count' values of an output of the computation. Floating
+   * point values are compared in ULPs (see --determinism-ulps), everything else
+   * exactly.
+   */
+  template <typename T>
+  void addOutput(const std::string& name, const T* data, size_t count)
+  {
+    static_assert(std::is_arithmetic<T>::value, "DeterminismContext::addOutput() compares arrays of numbers");
+    DeterminismOutput output;
+    output.Name = name;
+    output.Count = count;
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    output.Bytes.assign(bytes, bytes + count * sizeof(T));
+    output.Hash = 14695981039346656037ULL; // FNV-1a
+    for(unsigned char byte : output.Bytes)
+    {
+      output.Hash = (output.Hash ^ byte) * 1099511628211ULL;
+    }
+    output.Compare = &CompareDeterminismOutputs<T>;
+    m_Outputs.push_back(std::move(output));
+  }
+
+  template <typename T>
+  void addOutput(const std::string& name, const std::vector<T>& values)
+  {
+    addOutput(name, values.data(), values.size());
+  }
+
+  template <typename T>
+  void addOutput(const std::string& name, const T& value)
+  {
+    addOutput(name, &value, 1);
+  }
+
+private:
+  friend struct DeterminismRunner;
+
+  int m_Threads = 1;
+  Partitioner m_Partitioner = Partitioner::Static;
+  int m_Repeat = 0;
+  std::vector<DeterminismOutput> m_Outputs;
+#if defined(SIMPL_USE_PARALLEL_ALGORITHMS)
+  tbb::affinity_partitioner m_AffinityPartitioner; // Kept over the repeats, so they replay the recorded affinity
+#endif
+};
+
+struct DeterminismRunner
+{
+  static std::unique_ptr<DeterminismContext> CreateContext(int threads, Partitioner partitioner)
+  {
+    std::unique_ptr<DeterminismContext> ctx(new DeterminismContext);
+    ctx->m_Threads = threads;
+    ctx->m_Partitioner = partitioner;
+    return ctx;
+  }
+
+  /**
+   * @brief Runs the computation once and returns the outputs it recorded
+   */
+  static const std::vector<DeterminismOutput>& Run(const std::function<void(DeterminismContext&)>& fn, DeterminismContext& ctx, int repeat)
+  {
+    ctx.m_Repeat = repeat;
+    ctx.m_Outputs.clear();
+    fn(ctx);
+    return ctx.m_Outputs;
+  }
+
+  static std::vector<Partitioner> Partitioners()
+  {
+    std::vector<Partitioner> partitioners = {Partitioner::Static, Partitioner::Simple, Partitioner::Auto};
+#if defined(SIMPL_USE_PARALLEL_ALGORITHMS)
+    partitioners.push_back(Partitioner::Affinity);
+#endif
+    return partitioners;
+  }
+
+  static std::vector<int> ThreadCounts()
+  {
+    std::vector<int> threads = GetDeterminismOptions().Threads;
+    if(threads.empty())
+    {
+      threads = {1, 2, std::max(2, static_cast<int>(std::thread::hardware_concurrency()))};
+    }
+    std::sort(threads.begin(), threads.end());
+    threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+    threads.erase(std::remove_if(threads.begin(), threads.end(), [](int t) { return t < 1; }), threads.end());
+    return threads;
+  }
+};
+
+/**
+ * @brief Parses the --determinism-* arguments of the test executable. Unknown
+ * arguments are ignored so this can be handed the complete argument list.
+ */
+inline void ParseDeterminismArguments(int argc, char** argv)
+{
+  DeterminismOptions& options = GetDeterminismOptions();
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if(arg.compare(0, 22, "--determinism-threads=") == 0)
+    {
+      options.Threads.clear();
+      std::stringstream ss(arg.substr(22));
+      std::string item;
+      while(std::getline(ss, item, ','))
+      {
+        options.Threads.push_back(std::atoi(item.c_str()));
+      }
+    }
+    else if(arg.compare(0, 22, "--determinism-repeats=") == 0)
+    {
+      options.Repeats = std::max(1, std::atoi(arg.substr(22).c_str()));
+    }
+    else if(arg.compare(0, 19, "--determinism-ulps=") == 0)
+    {
+      options.MaxUlps = std::max(0, std::atoi(arg.substr(19).c_str()));
+    }
+  }
+}
+
+/**
+ * @brief Runs the computation 'fn' once on a single thread with the static
+ * partitioner as the reference, then for every thread count and partitioner
+ * --determinism-repeats times, and compares the outputs it recorded against the
+ * reference. All divergences are collected and thrown as a single
+ * TestException at the end.
+ */
+inline void RunDeterminismTest(const std::string& name, const std::function<void(DeterminismContext&)>& fn)
+{
+  DeterminismOptions& options = GetDeterminismOptions();
+  std::vector<int> threadCounts = DeterminismRunner::ThreadCounts();
+  std::vector<Partitioner> partitioners = DeterminismRunner::Partitioners();
+
+  std::unique_ptr<DeterminismContext> referenceContext = DeterminismRunner::CreateContext(1, Partitioner::Static);
+  const std::vector<DeterminismOutput> reference = DeterminismRunner::Run(fn, *referenceContext, 0);
+  if(reference.empty())
+  {
+    throw TestException(name + " did not record any output with DeterminismContext::addOutput()", __FILE__, __LINE__);
+  }
+
+  std::stringstream failures;
+  int runs = 0;
+  int divergentRuns = 0;
+  for(int threads : threadCounts)
+  {
+    for(Partitioner partitioner : partitioners)
+    {
+      std::unique_ptr<DeterminismContext> ctx = DeterminismRunner::CreateContext(threads, partitioner);
+      for(int repeat = 0; repeat < options.Repeats; repeat++)
+      {
+        const std::vector<DeterminismOutput>& outputs = DeterminismRunner::Run(fn, *ctx, repeat);
+        runs++;
+
+        std::stringstream ss;
+        if(outputs.size() != reference.size())
+        {
+          ss << "\n    recorded " << outputs.size() << " outputs instead of " << reference.size();
+        }
+        for(size_t i = 0; i < outputs.size() && i < reference.size(); i++)
+        {
+          const DeterminismOutput& expected = reference[i];
+          const DeterminismOutput& actual = outputs[i];
+          DeterminismOutput::Divergence divergence;
+          if(expected.Name != actual.Name || expected.Compare != actual.Compare)
+          {
+            ss << "\n    output " << i << " is '" << actual.Name << "' instead of '" << expected.Name << "' or has a different type";
+          }
+          else if(!expected.Compare(expected, actual, options.MaxUlps, divergence))
+          {
+            ss << "\n    '" << expected.Name << "': " << divergence.Elements << " of " << expected.Count << " values differ, first at [" << divergence.FirstIndex << "] " << divergence.Value
+               << " instead of " << divergence.Reference;
+            if(divergence.MaxUlps > 0)
+            {
+              ss << ", up to " << divergence.MaxUlps << " ULPs";
+            }
+          }
+        }
+        if(!ss.str().empty())
+        {
+          if(divergentRuns < 10)
+          {
+            failures << "\n  " << threads << " threads, " << PartitionerName(partitioner) << " partitioner, run " << repeat << ":" << ss.str();
+          }
+          divergentRuns++;
+        }
+      }
+    }
+  }
+
+  std::cout << "  Determinism " << name << ": " << runs << " runs over " << threadCounts.size() << " thread counts x " << partitioners.size() << " partitioners x " << options.Repeats
+            << " repeats, " << divergentRuns << " diverged from the single thread reference" << (options.MaxUlps > 0 ? " by more than " + std::to_string(options.MaxUlps) + " ULPs" : std::string())
+            << "\n";
+  if(divergentRuns > 0)
+  {
+    std::stringstream ss;
+    ss << divergentRuns << " of " << runs << " runs are not reproducible:" << failures.str();
+    if(divergentRuns > 10)
+    {
+      ss << "\n  ... and " << divergentRuns - 10 << " more runs";
+    }
+    throw TestException(ss.str(), __FILE__, __LINE__);
+  }
+}
+} // namespace unittest
+} // namespace SIMPL
+
+// -----------------------------------------------------------------------------
+// Developer Used Macros
+// -----------------------------------------------------------------------------
+#define DREAM3D_DETERMINISM_TEST(fn)                                                                                                                                                                   \
+  try                                                                                                                                                                                                  \
+  {                                                                                                                                                                                                    \
+    DREAM3D_ENTER_TEST(fn);                                                                                                                                                                            \
+    {                                                                                                                                                                                                  \
+      SIMPL::unittest::TestHookGuard testHookGuard(#fn);                                                                                                                                               \
+      SIMPL::unittest::RunDeterminismTest(#fn, fn);                                                                                                                                                    \
+    }                                                                                                                                                                                                  \
+    DREAM3D_LEAVE_TEST(fn)                                                                                                                                                                             \
+  } catch(TestException & e)                                                                                                                                                                           \
+  {                                                                                                                                                                                                    \
+    TestFailed(SIMPL::unittest::CurrentMethod, e);                                                                                                                                                     \
+    std::cout << e.what() << std::endl;                                                                                                                                                                \
+    err = EXIT_FAILURE;                                                                                                                                                                                \
+  }
@@ -0,0 +1,433 @@
+/* ============================================================================
+* Copyright (c) 2009-2016 BlueQuartz Software, LLC
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* Redistributions in binary form must reproduce the above copyright notice, this
+* list of conditions and the following disclaimer in the documentation and/or
+* other materials provided with the distribution.
+*
+* Neither the name of BlueQuartz Software, the US Air Force, nor the names of its
+* contributors may be used to endorse or promote products derived from this software
+* without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* The code contained herein was partially funded by the followig contracts:
+*    United States Air Force Prime Contract FA8650-07-D-5800
+*    United States Air Force Prime Contract FA8650-10-D-5210
+*    United States Prime Contract Navy N00173-07-C-2068
+*
+* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+//-- C Includes
+#include <stdint.h>
+#include <stdlib.h>
+
+//-- C++ Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEvent>
+#include <QtCore/QEventLoop>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+
+// The latency histogram that CMP generates next to cmpConfiguration.h, see AddSIMPLUnitTest
+#if defined(SIMPL_LATENCY_HISTOGRAM_HEADER)
+#include SIMPL_LATENCY_HISTOGRAM_HEADER
+#define SIMPL_HAVE_LATENCY_HISTOGRAM 1
+#endif
+
+#include "UnitTestSupport.hpp"
+
+namespace SIMPL
+{
+namespace unittest
+{
+// -----------------------------------------------------------------------------
+// Options that are set from the command line of the generated test executable
+// -----------------------------------------------------------------------------
+struct EventLoopOptions
+{
+  int ProbeIntervalMs = 5;   // --eventloop-probe-ms=N, how often the dispatch latency is probed
+  double MaxLatencyMs = 0.0; // --eventloop-max-latency-ms=N fails an async test whose event loop stalled longer (0 only reports)
+  int TimeoutMs = 0;         // --eventloop-timeout-ms=N replaces the timeouts given by the tests
+};
+
+inline EventLoopOptions& GetEventLoopOptions()
+{
+  static EventLoopOptions options;
+  return options;
+}
+
+/**
+ * @brief Measures how long events wait in the event loop of the main thread. A
+ * separate thread posts a time stamped probe event every ProbeIntervalMs, so a
+ * stalled loop shows up with the delay every event posted during the stall
+ * sees, the way a user clicking on a busy application would.
+ */
+class EventLoopLatencyMonitor : public QObject
+{
+public:
+  EventLoopLatencyMonitor() = default;
+  ~EventLoopLatencyMonitor() override
+  {
+    stop();
+  }
+
+  void start(int intervalMs)
+  {
+    m_Stop = false;
+    m_Thread = std::thread([this, intervalMs]() {
+      while(!m_Stop.load())
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::max(1, intervalMs)));
+        QCoreApplication::postEvent(this, new ProbeEvent(std::chrono::steady_clock::now()));
+      }
+    });
+  }
+
+  /**
+   * @brief Stops the probes. Probes that are still queued are dropped.
+   */
+  void stop()
+  {
+    m_Stop = true;
+    if(m_Thread.joinable())
+    {
+      m_Thread.join();
+    }
+  }
+
+  bool event(QEvent* event) override
+  {
+    if(event->type() != ProbeEvent::Type())
+    {
+      return QObject::event(event);
+    }
+    uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - static_cast<ProbeEvent*>(event)->Posted).count());
+#if defined(SIMPL_HAVE_LATENCY_HISTOGRAM)
+    m_Latencies.record(ns);
+#endif
+    m_Count++;
+    m_MaxNs = std::max(m_MaxNs, ns);
+    return true;
+  }
+
+  uint64_t count() const
+  {
+    return m_Count;
+  }
+  double maxMilliseconds() const
+  {
+    return static_cast<double>(m_MaxNs) * 1.0e-6;
+  }
+
+  std::string summary() const
+  {
+#if defined(SIMPL_HAVE_LATENCY_HISTOGRAM)
+    return m_Latencies.summary();
+#else
+    std::stringstream ss;
+    ss << "max " << maxMilliseconds() << " ms (n=" << m_Count << ")";
+    return ss.str();
+#endif
+  }
+
+private:
+  struct ProbeEvent : public QEvent
+  {
+    explicit ProbeEvent(std::chrono::steady_clock::time_point posted)
+    : QEvent(Type())
+    , Posted(posted)
+    {
+    }
+    static QEvent::Type Type()
+    {
+      static const QEvent::Type type = static_cast<QEvent::Type>(QEvent::registerEventType());
+      return type;
+    }
+    std::chrono::steady_clock::time_point Posted;
+  };
+
+  std::thread m_Thread;
+  std::atomic<bool> m_Stop = {false};
+  uint64_t m_Count = 0;
+  uint64_t m_MaxNs = 0;
+#if defined(SIMPL_HAVE_LATENCY_HISTOGRAM)
+  cmp::LatencyHistogram m_Latencies;
+#endif
+};
+
+/**
+ * @brief Handed to an async test. The test finishes when done() or fail() is
+ * called, from any thread. Callbacks that the event loop runs have to be
+ * wrapped with guard() so that a failing DREAM3D_REQUIRE inside of them fails
+ * the test instead of unwinding through the event loop.
+ */
+class AsyncTest : public QObject
+{
+public:
+  explicit AsyncTest(const std::string& name)
+  : m_Name(name)
+  {
+  }
+
+  const std::string& name() const
+  {
+    return m_Name;
+  }
+
+  void done()
+  {
+    finish(std::string(), std::string(), 0);
+  }
+
+  void fail(const std::string& message, const std::string& file = std::string(), int line = 0)
+  {
+    finish(message.empty() ? std::string("The test failed") : message, file, line);
+  }
+
+  template <typename Fn> std::function<void()> guard(Fn fn)
+  {
+    return [this, fn]() {
+      try
+      {
+        fn();
+      } catch(TestException& e)
+      {
+        fail(e.getMessage(), e.getFileName(), e.getLineNumber());
+      } catch(std::exception& e)
+      {
+        fail(std::string("Unexpected exception: ") + e.what());
+      } catch(...)
+      {
+        fail("Unknown exception");
+      }
+    };
+  }
+
+  bool finished() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_Finished;
+  }
+
+  /**
+   * @brief Throws the TestException of a failed test
+   */
+  void rethrow() const
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if(!m_Message.empty())
+    {
+      throw TestException(m_Message, m_File, m_Line);
+    }
+  }
+
+  /**
+   * @brief The event loop that finish() leaves
+   */
+  void setEventLoop(QEventLoop* loop)
+  {
+    m_Loop = loop;
+  }
+
+  bool event(QEvent* event) override
+  {
+    if(event->type() != FinishedEvent::Type())
+    {
+      return QObject::event(event);
+    }
+    if(nullptr != m_Loop)
+    {
+      m_Loop->quit();
+    }
+    return true;
+  }
+
+private:
+  struct FinishedEvent : public QEvent
+  {
+    FinishedEvent()
+    : QEvent(Type())
+    {
+    }
+    static QEvent::Type Type()
+    {
+      static const QEvent::Type type = static_cast<QEvent::Type>(QEvent::registerEventType());
+      return type;
+    }
+  };
+
+  /* The first call wins; the event loop is left from its own thread */
+  void finish(const std::string& message, const std::string& file, int line)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      if(m_Finished)
+      {
+        return;
+      }
+      m_Finished = true;
+      m_Message = message;
+      m_File = file;
+      m_Line = line;
+    }
+    QCoreApplication::postEvent(this, new FinishedEvent);
+  }
+
+  std::string m_Name;
+  QEventLoop* m_Loop = nullptr;
+  mutable std::mutex m_Mutex;
+  bool m_Finished = false;
+  std::string m_Message;
+  std::string m_File;
+  int m_Line = 0;
+};
+
+/**
+ * @brief Runs 'fn' inside of a local QEventLoop until it calls done() or fail()
+ * on the AsyncTest it is handed, or until 'timeoutMs' passed. A local loop
+ * leaves the QCoreApplication alone: aboutToQuit is not emitted and the objects
+ * deleted with deleteLater() outside of the test stay alive. The dispatch
+ * latency of the event loop is measured meanwhile and reported; with
+ * --eventloop-max-latency-ms a stall longer than that fails the test.
+ */
+inline void RunAsyncTest(const std::string& name, const std::function<void(AsyncTest&)>& fn, int timeoutMs)
+{
+  const EventLoopOptions& options = GetEventLoopOptions();
+  if(nullptr == QCoreApplication::instance())
+  {
+    throw TestException("Async tests need a QCoreApplication", __FILE__, __LINE__);
+  }
+  if(options.TimeoutMs > 0)
+  {
+    timeoutMs = options.TimeoutMs;
+  }
+
+  QEventLoop loop;
+  AsyncTest test(name);
+  test.setEventLoop(&loop);
+  EventLoopLatencyMonitor monitor;
+  monitor.start(options.ProbeIntervalMs);
+  QTimer::singleShot(0, &test, test.guard([&test, &fn]() { fn(test); }));
+  QTimer::singleShot(timeoutMs, &test, [&test, timeoutMs]() { test.fail("The test did not finish within " + std::to_string(timeoutMs) + " ms", __FILE__, __LINE__); });
+  auto start = std::chrono::steady_clock::now();
+  int result = loop.exec();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  monitor.stop();
+
+  std::cout << "  Async " << name << ": " << seconds * 1000.0 << " ms in the event loop, dispatch latency " << monitor.summary() << "\n";
+  if(result != 0 || !test.finished())
+  {
+    throw TestException("The event loop returned " + std::to_string(result) + " before the test finished, something called QCoreApplication::exit()", __FILE__, __LINE__);
+  }
+  test.rethrow();
+  if(options.MaxLatencyMs > 0.0 && monitor.maxMilliseconds() > options.MaxLatencyMs)
+  {
+    std::stringstream ss;
+    ss << "The event loop stalled for " << monitor.maxMilliseconds() << " ms, more than the " << options.MaxLatencyMs << " ms allowed by --eventloop-max-latency-ms";
+    throw TestException(ss.str(), __FILE__, __LINE__);
+  }
+}
+
+/**
+ * @brief Runs 'fn' inside of the event loop and finishes the test once the
+ * future it returns is ready. The future is polled every millisecond; an
+ * exception it holds fails the test.
+ */
+inline void RunAsyncTest(const std::string& name, const std::function<std::future<void>()>& fn, int timeoutMs)
+{
+  std::shared_ptr<std::future<void>> future = std::make_shared<std::future<void>>();
+  std::shared_ptr<std::function<void()>> poll = std::make_shared<std::function<void()>>();
+  RunAsyncTest(name,
+               [&fn, future, poll](AsyncTest& test) {
+                 *future = fn();
+                 *poll = test.guard([&test, future, poll]() {
+                   if(future->wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                   {
+                     QTimer::singleShot(1, &test, *poll);
+                     return;
+                   }
+                   future->get();
+                   test.done();
+                 });
+                 (*poll)();
+               },
+               timeoutMs);
+  *poll = nullptr; // It holds a reference to itself
+}
+
+/**
+ * @brief Parses the --eventloop-* arguments of the test executable. Unknown
+ * arguments are ignored so this can be handed the complete argument list.
+ */
+inline void ParseEventLoopArguments(int argc, char** argv)
+{
+  EventLoopOptions& options = GetEventLoopOptions();
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if(arg.compare(0, 21, "--eventloop-probe-ms=") == 0)
+    {
+      options.ProbeIntervalMs = std::atoi(arg.substr(21).c_str());
+    }
+    else if(arg.compare(0, 27, "--eventloop-max-latency-ms=") == 0)
+    {
+      options.MaxLatencyMs = std::atof(arg.substr(27).c_str());
+    }
+    else if(arg.compare(0, 23, "--eventloop-timeout-ms=") == 0)
+    {
+      options.TimeoutMs = std::atoi(arg.substr(23).c_str());
+    }
+  }
+}
+} // namespace unittest
+} // namespace SIMPL
+
+// -----------------------------------------------------------------------------
+// Developer Used Macros
+// -----------------------------------------------------------------------------
+/* fn is either void fn(SIMPL::unittest::AsyncTest&) that calls done() or fail(),
+ * or std::future<void> fn() */
+#define DREAM3D_REGISTER_ASYNC_TEST(fn, timeoutMs)                                                                                                                                                     \
+  try                                                                                                                                                                                                  \
+  {                                                                                                                                                                                                    \
+    DREAM3D_ENTER_TEST(fn);                                                                                                                                                                            \
+    {                                                                                                                                                                                                  \
+      SIMPL::unittest::TestHookGuard testHookGuard(#fn);                                                                                                                                               \
+      SIMPL::unittest::RunAsyncTest(#fn, fn, timeoutMs);                                                                                                                                               \
+    }                                                                                                                                                                                                  \
+    DREAM3D_LEAVE_TEST(fn)                                                                                                                                                                             \
+  } catch(TestException & e)                                                                                                                                                                           \
+  {                                                                                                                                                                                                    \
+    TestFailed(SIMPL::unittest::CurrentMethod, e);                                                                                                                                                     \
+    std::cout << e.what() << std::endl;                                                                                                                                                                \
+    err = EXIT_FAILURE;                                                                                                                                                                                \
+  }
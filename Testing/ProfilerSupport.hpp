@@ -0,0 +1,438 @@
+/* ============================================================================
+* Copyright (c) 2009-2016 BlueQuartz Software, LLC
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* Redistributions in binary form must reproduce the above copyright notice, this
+* list of conditions and the following disclaimer in the documentation and/or
+* other materials provided with the distribution.
+*
+* Neither the name of BlueQuartz Software, the US Air Force, nor the names of its
+* contributors may be used to endorse or promote products derived from this software
+* without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* The code contained herein was partially funded by the followig contracts:
+*    United States Air Force Prime Contract FA8650-07-D-5800
+*    United States Air Force Prime Contract FA8650-10-D-5210
+*    United States Prime Contract Navy N00173-07-C-2068
+*
+* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+//-- C Includes
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#define SIMPL_PROFILER_SUPPORTED 1
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+//-- C++ Includes
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "UnitTestSupport.hpp"
+
+namespace SIMPL
+{
+namespace unittest
+{
+// -----------------------------------------------------------------------------
+// Options that are set from the command line of the generated test executable
+// -----------------------------------------------------------------------------
+struct ProfilerOptions
+{
+  bool Enabled = false;        // --profile or --profile=<part of the test name>
+  std::string Filter;          // Only tests whose name contains this are profiled
+  std::string OutputDir = "."; // --profile-dir=path
+  int Frequency = 499;         // --profile-hz=N samples per second of cpu time
+  int TopN = 20;               // --profile-top=N functions in the summary
+};
+
+inline ProfilerOptions& GetProfilerOptions()
+{
+  static ProfilerOptions options;
+  return options;
+}
+
+// -----------------------------------------------------------------------------
+// A SIGPROF based sampling profiler for the DREAM3D_REGISTER_TEST runs. The timer
+// fires every 1/Frequency seconds of cpu time used by the process, on whichever
+// thread is running. The signal handler only stores the raw return addresses into
+// a preallocated buffer, symbolizing and folding the stacks happens after the test.
+// The output for each test is <OutputDir>/<test>.folded, one "a;b;c count" line
+// per distinct stack as read by flamegraph.pl and speedscope, plus a summary of the
+// hottest functions on std::cout.
+// -----------------------------------------------------------------------------
+namespace profiler
+{
+const int MaxFrames = 64;
+const size_t MaxSamples = 32768;
+
+struct Sample
+{
+  int Depth;
+  void* Frames[MaxFrames];
+};
+
+struct SampleBuffer
+{
+  std::atomic<bool> Active;
+  std::atomic<int> InHandler;
+  std::atomic<size_t> Count;
+  Sample* Samples;
+};
+
+inline SampleBuffer& GetSampleBuffer()
+{
+  static SampleBuffer buffer = {{false}, {0}, {0}, nullptr};
+  return buffer;
+}
+
+#if defined(SIMPL_PROFILER_SUPPORTED)
+/**
+ * @brief The SIGPROF handler. backtrace() is not async-signal-safe in general:
+ * its first call dlopen()s libgcc_s for the unwinder, which takes the loader
+ * lock and allocates. Start() makes that first call before the handler is
+ * installed and the timer armed, so here backtrace() only walks the stack with
+ * the already loaded unwinder, which does not allocate. A sample that lands in
+ * the middle of a dlopen() of the profiled code can still wait for the loader
+ * lock; everything else here is lock free.
+ */
+inline void SignalHandler(int)
+{
+  int savedErrno = errno;
+  SampleBuffer& buffer = GetSampleBuffer();
+  buffer.InHandler.fetch_add(1);
+  if(buffer.Active.load())
+  {
+    size_t index = buffer.Count.fetch_add(1);
+    if(index < MaxSamples)
+    {
+      Sample& sample = buffer.Samples[index];
+      sample.Depth = backtrace(sample.Frames, MaxFrames);
+    }
+  }
+  buffer.InHandler.fetch_sub(1);
+  errno = savedErrno;
+}
+
+struct SavedSignalState
+{
+  struct sigaction Action;
+};
+
+inline SavedSignalState& GetSavedSignalState()
+{
+  static SavedSignalState state;
+  return state;
+}
+#endif
+
+/**
+ * @brief Starts sampling. Returns false if the platform has no SIGPROF.
+ */
+inline bool Start(int frequency)
+{
+#if defined(SIMPL_PROFILER_SUPPORTED)
+  SampleBuffer& buffer = GetSampleBuffer();
+  if(nullptr == buffer.Samples)
+  {
+    buffer.Samples = new Sample[MaxSamples];
+  }
+  // The first call of backtrace() loads libgcc_s, which locks and allocates.
+  // Make it here, before SIGPROF is handled, so SignalHandler() never does.
+  void* warmUp[4];
+  backtrace(warmUp, 4);
+
+  buffer.Count.store(0);
+  buffer.Active.store(true);
+  struct sigaction action;
+  ::memset(&action, 0, sizeof(action));
+  action.sa_handler = &SignalHandler;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if(sigaction(SIGPROF, &action, &GetSavedSignalState().Action) != 0)
+  {
+    buffer.Active.store(false);
+    return false;
+  }
+  // tv_usec has to stay below one second, --profile-hz=1 needs tv_sec
+  const int period = std::max(1, 1000000 / std::max(1, frequency));
+  struct itimerval timer;
+  timer.it_interval.tv_sec = period / 1000000;
+  timer.it_interval.tv_usec = period % 1000000;
+  timer.it_value = timer.it_interval;
+  return setitimer(ITIMER_PROF, &timer, nullptr) == 0;
+#else
+  (void)frequency;
+  return false;
+#endif
+}
+
+/**
+ * @brief Stops sampling and waits until no signal handler is running anymore
+ */
+inline void Stop()
+{
+#if defined(SIMPL_PROFILER_SUPPORTED)
+  struct itimerval timer;
+  ::memset(&timer, 0, sizeof(timer));
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  SampleBuffer& buffer = GetSampleBuffer();
+  buffer.Active.store(false);
+  while(buffer.InHandler.load() != 0)
+  {
+    std::this_thread::yield();
+  }
+  sigaction(SIGPROF, &GetSavedSignalState().Action, nullptr);
+#endif
+}
+
+/**
+ * @brief Function name of a code address. Falls back to "module+0xoffset" for
+ * functions that are not in the dynamic symbol table (static functions, or
+ * executables linked without -rdynamic, i.e. without CMP_UNIT_TEST_PROFILER),
+ * which addr2line can resolve later.
+ */
+inline std::string Symbolize(void* address)
+{
+#if defined(SIMPL_PROFILER_SUPPORTED)
+  Dl_info info;
+  if(dladdr(address, &info) != 0)
+  {
+    if(nullptr != info.dli_sname)
+    {
+      int status = 0;
+      char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+      std::string name = (status == 0 && nullptr != demangled) ? demangled : info.dli_sname;
+      ::free(demangled);
+      return name;
+    }
+    if(nullptr != info.dli_fname)
+    {
+      std::string module(info.dli_fname);
+      std::string::size_type slash = module.find_last_of('/');
+      std::stringstream ss;
+      ss << (slash == std::string::npos ? module : module.substr(slash + 1)) << "+0x" << std::hex
+         << (reinterpret_cast<uintptr_t>(address) - reinterpret_cast<uintptr_t>(info.dli_fbase));
+      return ss.str();
+    }
+  }
+#endif
+  std::stringstream ss;
+  ss << "0x" << std::hex << reinterpret_cast<uintptr_t>(address);
+  return ss.str();
+}
+
+/**
+ * @brief Turns a test name like "TestFoo()" into something usable as a file name
+ */
+inline std::string FileNameOf(const std::string& testName)
+{
+  std::string name;
+  for(char c : testName)
+  {
+    bool keep = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-';
+    name += keep ? c : '_';
+  }
+  while(!name.empty() && name.back() == '_')
+  {
+    name.pop_back();
+  }
+  return name.empty() ? std::string("test") : name;
+}
+
+/**
+ * @brief Symbolizes the samples taken since Start(), writes the folded stacks of
+ * 'testName' and prints the hottest functions
+ */
+inline void Report(const std::string& testName)
+{
+  const ProfilerOptions& options = GetProfilerOptions();
+  SampleBuffer& buffer = GetSampleBuffer();
+  size_t taken = buffer.Count.load();
+  size_t numSamples = std::min(taken, MaxSamples);
+
+  // The innermost two frames are the signal handler and the signal trampoline
+  const int skip = 2;
+  std::map<void*, std::string> symbols;
+  std::map<std::string, size_t> folded;
+  std::map<std::string, size_t> self;
+  std::map<std::string, size_t> total;
+  for(size_t i = 0; i < numSamples; i++)
+  {
+    const Sample& sample = buffer.Samples[i];
+    std::vector<std::string> names;
+    for(int f = sample.Depth - 1; f >= skip; f--)
+    {
+      // Return addresses point behind the call, look up the call itself
+      void* address = sample.Frames[f];
+      void* lookup = (f == skip) ? address : reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(address) - 1);
+      std::map<void*, std::string>::iterator iter = symbols.find(lookup);
+      if(iter == symbols.end())
+      {
+        iter = symbols.insert(std::make_pair(lookup, Symbolize(lookup))).first;
+      }
+      names.push_back(iter->second);
+    }
+    if(names.empty())
+    {
+      continue;
+    }
+    std::string stack;
+    std::set<std::string> seen;
+    for(const std::string& name : names)
+    {
+      std::string frame = name;
+      std::replace(frame.begin(), frame.end(), ';', ':');
+      stack += (stack.empty() ? "" : ";") + frame;
+      if(seen.insert(name).second)
+      {
+        total[name]++;
+      }
+    }
+    folded[stack]++;
+    self[names.back()]++;
+  }
+
+  std::string filePath = options.OutputDir + "/" + FileNameOf(testName) + ".folded";
+  std::ofstream out(filePath.c_str());
+  for(const std::pair<const std::string, size_t>& entry : folded)
+  {
+    out << entry.first << " " << entry.second << "\n";
+  }
+
+  std::cout << "  Profile " << testName << ": " << numSamples << " samples at " << options.Frequency << " Hz";
+  if(taken > numSamples)
+  {
+    std::cout << " (" << taken - numSamples << " dropped, lower --profile-hz)";
+  }
+  std::cout << " -> " << filePath << "\n";
+  if(numSamples == 0)
+  {
+    return;
+  }
+  std::vector<std::pair<size_t, std::string>> hottest;
+  for(const std::pair<const std::string, size_t>& entry : self)
+  {
+    hottest.push_back(std::make_pair(entry.second, entry.first));
+  }
+  std::sort(hottest.begin(), hottest.end(), [](const std::pair<size_t, std::string>& a, const std::pair<size_t, std::string>& b) { return a.first > b.first; });
+  std::cout << "     self%  total%  function\n";
+  for(size_t i = 0; i < hottest.size() && i < static_cast<size_t>(options.TopN); i++)
+  {
+    // A local stream, std::cout keeps its formatting
+    std::ostringstream row;
+    row << "    " << std::fixed << std::setprecision(1) << std::setw(6) << 100.0 * hottest[i].first / numSamples << "  " << std::setw(6) << 100.0 * total[hottest[i].second] / numSamples << "  "
+        << hottest[i].second << "\n";
+    std::cout << row.str();
+  }
+}
+
+inline bool ShouldProfile(const std::string& testName)
+{
+  const ProfilerOptions& options = GetProfilerOptions();
+  return options.Enabled && (options.Filter.empty() || testName.find(options.Filter) != std::string::npos);
+}
+
+inline void TestStarted(const std::string& testName)
+{
+  if(ShouldProfile(testName) && !Start(GetProfilerOptions().Frequency))
+  {
+    std::cout << "  WARNING: Could not start the profiler for " << testName << "\n";
+  }
+}
+
+inline void TestFinished(const std::string& testName)
+{
+  if(ShouldProfile(testName))
+  {
+    Stop();
+    Report(testName);
+  }
+}
+} // namespace profiler
+
+// -----------------------------------------------------------------------------
+//
+// -----------------------------------------------------------------------------
+/**
+ * @brief Parses the profiler related arguments of the test executable and, if
+ * profiling was asked for, hooks the profiler into DREAM3D_REGISTER_TEST. Unknown
+ * arguments are ignored so this can be handed the complete argument list.
+ */
+inline void ParseProfilerArguments(int argc, char** argv)
+{
+  ProfilerOptions& options = GetProfilerOptions();
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if(arg == "--profile")
+    {
+      options.Enabled = true;
+    }
+    else if(arg.compare(0, 10, "--profile=") == 0)
+    {
+      options.Enabled = true;
+      options.Filter = arg.substr(10);
+    }
+    else if(arg.compare(0, 14, "--profile-dir=") == 0)
+    {
+      options.OutputDir = arg.substr(14);
+    }
+    else if(arg.compare(0, 13, "--profile-hz=") == 0)
+    {
+      options.Frequency = std::max(1, std::atoi(arg.substr(13).c_str()));
+    }
+    else if(arg.compare(0, 14, "--profile-top=") == 0)
+    {
+      options.TopN = std::max(1, std::atoi(arg.substr(14).c_str()));
+    }
+  }
+  if(!options.Enabled)
+  {
+    return;
+  }
+#if defined(SIMPL_PROFILER_SUPPORTED)
+  TestStartedHooks.push_back(&profiler::TestStarted);
+  TestFinishedHooks.push_back(&profiler::TestFinished);
+#else
+  std::cout << "WARNING: --profile needs SIGPROF, which this platform does not have\n";
+#endif
+}
+} // namespace unittest
+} // namespace SIMPL
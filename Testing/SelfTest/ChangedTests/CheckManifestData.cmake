@@ -0,0 +1,24 @@
+#-------------------------------------------------------------------------------
+# Fails unless the manifest CMP_MANIFEST_FILE lists CMP_EXPECTED_DATA, an
+# existing file, as data= and nothing else that is missing.
+#-------------------------------------------------------------------------------
+cmake_minimum_required(VERSION 3.12)
+
+if(NOT EXISTS "${CMP_MANIFEST_FILE}")
+  message(FATAL_ERROR "The manifest ${CMP_MANIFEST_FILE} was not written")
+endif()
+file(STRINGS "${CMP_MANIFEST_FILE}" lines REGEX "^data=")
+set(found FALSE)
+foreach(line ${lines})
+  string(REGEX REPLACE "^data=" "" item "${line}")
+  if(NOT EXISTS "${item}")
+    message(FATAL_ERROR "The manifest lists the data ${item}, which does not exist")
+  endif()
+  if("${item}" STREQUAL "${CMP_EXPECTED_DATA}")
+    set(found TRUE)
+  endif()
+endforeach()
+if(NOT found)
+  message(FATAL_ERROR "The manifest does not list ${CMP_EXPECTED_DATA}: ${lines}")
+endif()
+message(STATUS "The manifest lists ${CMP_EXPECTED_DATA}")
@@ -0,0 +1,94 @@
+/* ============================================================================
+* Copyright (c) 2009-2016 BlueQuartz Software, LLC
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* Redistributions in binary form must reproduce the above copyright notice, this
+* list of conditions and the following disclaimer in the documentation and/or
+* other materials provided with the distribution.
+*
+* Neither the name of BlueQuartz Software, the US Air Force, nor the names of its
+* contributors may be used to endorse or promote products derived from this software
+* without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* The code contained herein was partially funded by the followig contracts:
+*    United States Air Force Prime Contract FA8650-07-D-5800
+*    United States Air Force Prime Contract FA8650-10-D-5210
+*    United States Prime Contract Navy N00173-07-C-2068
+*
+* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "BenchmarkSupport.hpp"
+
+namespace
+{
+const size_t k_NumElements = 100000;
+std::vector<double> s_Values(k_NumElements, 1.0);
+double s_Sum = 0.0;
+} // namespace
+
+// -----------------------------------------------------------------------------
+//
+// -----------------------------------------------------------------------------
+void SumValues()
+{
+  s_Sum = std::accumulate(s_Values.begin(), s_Values.end(), 0.0);
+}
+
+// -----------------------------------------------------------------------------
+//
+// -----------------------------------------------------------------------------
+void PerElementIsReported()
+{
+  std::ifstream file(BENCHMARK_RESULTS_FILE);
+  DREAM3D_REQUIRE(file.is_open())
+  std::string record;
+  DREAM3D_REQUIRE(static_cast<bool>(std::getline(file, record)))
+  DREAM3D_REQUIRE(record.find("\"elements\":100000") != std::string::npos)
+  DREAM3D_REQUIRE(record.find("\"median_s_per_element\":") != std::string::npos)
+  // The energy only where the RAPL counters can be read
+  if(record.find("\"available\":true") != std::string::npos)
+  {
+    DREAM3D_REQUIRE(record.find("\"joules_per_element\":") != std::string::npos)
+  }
+}
+
+// -----------------------------------------------------------------------------
+//  Use test framework
+// -----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  int err = EXIT_SUCCESS;
+
+  std::remove(BENCHMARK_RESULTS_FILE);
+  std::string resultsArg = std::string("--bench-results=") + BENCHMARK_RESULTS_FILE;
+  char* benchmarkArgs[] = {argv[0], &resultsArg[0]};
+  SIMPL::unittest::ParseBenchmarkArguments(2, benchmarkArgs);
+
+  DREAM3D_REGISTER_BENCHMARK_ELEMENTS(SumValues(), 5, k_NumElements * sizeof(double), k_NumElements, k_NumElements)
+  DREAM3D_REGISTER_TEST(PerElementIsReported())
+
+  PRINT_TEST_SUMMARY();
+  return err;
+}
@@ -0,0 +1,82 @@
+/* ============================================================================
+* Copyright (c) 2009-2016 BlueQuartz Software, LLC
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* Redistributions in binary form must reproduce the above copyright notice, this
+* list of conditions and the following disclaimer in the documentation and/or
+* other materials provided with the distribution.
+*
+* Neither the name of BlueQuartz Software, the US Air Force, nor the names of its
+* contributors may be used to endorse or promote products derived from this software
+* without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* The code contained herein was partially funded by the followig contracts:
+*    United States Air Force Prime Contract FA8650-07-D-5800
+*    United States Air Force Prime Contract FA8650-10-D-5210
+*    United States Prime Contract Navy N00173-07-C-2068
+*
+* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#include <cmath>
+
+#include "DeterminismSupport.hpp"
+
+// -----------------------------------------------------------------------------
+//
+// -----------------------------------------------------------------------------
+void FloatUlpDistance()
+{
+  using SIMPL::unittest::UlpDistance;
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(1.0f, 1.0f), 0)
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(-0.0f, 0.0f), 0)
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(0.0f, -0.0f), 0)
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(1.0f, std::nextafter(1.0f, 2.0f)), 1)
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(-1.0f, std::nextafter(-1.0f, -2.0f)), 1)
+  // Across the sign: one step from the smallest denormal to each zero
+  const float denormal = std::nextafter(0.0f, 1.0f);
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(-denormal, denormal), 2)
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(denormal, -denormal), 2)
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(-denormal, 0.0f), 1)
+}
+
+// -----------------------------------------------------------------------------
+//
+// -----------------------------------------------------------------------------
+void DoubleUlpDistance()
+{
+  using SIMPL::unittest::UlpDistance;
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(-0.0, 0.0), 0)
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(1.0, std::nextafter(1.0, 2.0)), 1)
+  const double denormal = std::nextafter(0.0, 1.0);
+  DREAM3D_REQUIRE_EQUAL(UlpDistance(-denormal, denormal), 2)
+}
+
+// -----------------------------------------------------------------------------
+//  Use test framework
+// -----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  int err = EXIT_SUCCESS;
+
+  DREAM3D_REGISTER_TEST(FloatUlpDistance())
+  DREAM3D_REGISTER_TEST(DoubleUlpDistance())
+
+  PRINT_TEST_SUMMARY();
+  return err;
+}
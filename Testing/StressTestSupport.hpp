@@ -0,0 +1,529 @@
+/* ============================================================================
+* Copyright (c) 2009-2016 BlueQuartz Software, LLC
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* Redistributions in binary form must reproduce the above copyright notice, this
+* list of conditions and the following disclaimer in the documentation and/or
+* other materials provided with the distribution.
+*
+* Neither the name of BlueQuartz Software, the US Air Force, nor the names of its
+* contributors may be used to endorse or promote products derived from this software
+* without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* The code contained herein was partially funded by the followig contracts:
+*    United States Air Force Prime Contract FA8650-07-D-5800
+*    United States Air Force Prime Contract FA8650-10-D-5210
+*    United States Prime Contract Navy N00173-07-C-2068
+*
+* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+//-- C Includes
+#include <stdint.h>
+#include <stdlib.h>
+
+//-- C++ Includes
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "UnitTestSupport.hpp"
+
+namespace SIMPL
+{
+namespace unittest
+{
+// -----------------------------------------------------------------------------
+// Options that are set from the command line of the generated test executable
+// -----------------------------------------------------------------------------
+struct StressTestOptions
+{
+  double YieldProbability = 0.0; // --stress-yield=P (or SIMPL_STRESS_YIELD), chance that StressContext::maybeYield() yields
+  int Iterations = 0;            // --stress-iterations=N (0 uses the value given by the test)
+  uint64_t Seed = 0;             // --stress-seed=S (or SIMPL_STRESS_SEED), 0 picks a new seed for every run
+};
+
+inline StressTestOptions& GetStressTestOptions()
+{
+  static StressTestOptions options;
+  return options;
+}
+
+/**
+ * @brief Handed to the function under test on every thread of every iteration.
+ * The function reports how much work it did through addOperations() and can
+ * call maybeYield() at interesting points to shake up the interleavings. Code
+ * that waits on other threads should also check stopRequested() so that a
+ * failure on one thread does not leave the others waiting forever.
+ */
+class StressContext
+{
+public:
+  int threadIndex() const
+  {
+    return m_ThreadIndex;
+  }
+  int numThreads() const
+  {
+    return m_NumThreads;
+  }
+  int iteration() const
+  {
+    return m_Iteration;
+  }
+
+  /**
+   * @brief Yields the thread with the probability given by --stress-yield
+   */
+  void maybeYield()
+  {
+    if(m_YieldThreshold != 0 && static_cast<uint32_t>(next() >> 32) < m_YieldThreshold)
+    {
+      std::this_thread::yield();
+    }
+  }
+
+  /**
+   * @brief Adds to the number of operations this thread performed. If this is
+   * never called every invocation counts as a single operation.
+   */
+  void addOperations(uint64_t count)
+  {
+    m_Operations += count;
+    m_CountedOperations = true;
+  }
+
+  /**
+   * @brief True once any thread of the current iteration has failed
+   */
+  bool stopRequested() const
+  {
+    return m_Stop->load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief A per thread and per iteration random number that is reproducible from the seed
+   */
+  uint64_t next()
+  {
+    m_Random ^= m_Random << 13;
+    m_Random ^= m_Random >> 7;
+    m_Random ^= m_Random << 17;
+    return m_Random;
+  }
+
+private:
+  friend struct StressRunner;
+
+  int m_ThreadIndex = 0;
+  int m_NumThreads = 1;
+  int m_Iteration = 0;
+  uint32_t m_YieldThreshold = 0;
+  uint64_t m_Random = 1;
+  uint64_t m_Operations = 0;
+  bool m_CountedOperations = false;
+  const std::atomic<bool>* m_Stop = nullptr;
+};
+
+/**
+ * @brief A failure of one thread (or of the verification, Thread == -1) in one iteration
+ */
+struct StressFailure
+{
+  int Iteration;
+  int Thread;
+  std::string Message;
+};
+
+struct StressTestResult
+{
+  int Threads = 0;
+  int Iterations = 0;
+  int FailedIterations = 0;
+  std::vector<StressFailure> Failures;
+  double OpsPerSecondPerThread = 0.0; // Mean over the threads
+  double MinOpsPerSecondPerThread = 0.0;
+  double MaxOpsPerSecondPerThread = 0.0;
+  double SingleThreadOpsPerSecond = 0.0;
+  double ScalingLoss = 0.0; // 1 - OpsPerSecondPerThread / SingleThreadOpsPerSecond
+  uint64_t Seed = 0;
+};
+
+/**
+ * @brief A reusable barrier that spins so that all threads leave it as close to
+ * the same moment as possible. It falls back to yielding when the machine has
+ * fewer cores than waiting threads.
+ */
+class SpinBarrier
+{
+public:
+  explicit SpinBarrier(int count)
+  : m_Count(count)
+  {
+  }
+
+  void arriveAndWait()
+  {
+    unsigned generation = m_Generation.load(std::memory_order_acquire);
+    if(m_Arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_Count)
+    {
+      m_Arrived.store(0, std::memory_order_relaxed);
+      m_Generation.fetch_add(1, std::memory_order_release);
+      return;
+    }
+    int spins = 0;
+    while(m_Generation.load(std::memory_order_acquire) == generation)
+    {
+      if(++spins > 4096)
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+private:
+  const int m_Count;
+  std::atomic<int> m_Arrived = {0};
+  std::atomic<unsigned> m_Generation = {0};
+
+  SpinBarrier(const SpinBarrier&) = delete;
+  void operator=(const SpinBarrier&) = delete;
+};
+
+struct StressRunner
+{
+  struct Pass
+  {
+    std::vector<uint64_t> Operations;
+    std::vector<double> Seconds;
+    std::vector<StressFailure> Failures;
+    int FailedIterations = 0;
+  };
+
+  static uint64_t SplitMix64(uint64_t x)
+  {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+  }
+
+  /**
+   * @brief Runs 'iterations' rounds of 'fn' on 'numThreads' threads. The threads are
+   * created once and released together from a barrier at the start of every round.
+   */
+  static Pass Run(const std::function<void(StressContext&)>& fn, const std::function<void(int)>& verify, int numThreads, int iterations, uint64_t seed, double yieldProbability)
+  {
+    Pass pass;
+    pass.Operations.assign(numThreads, 0);
+    pass.Seconds.assign(numThreads, 0.0);
+
+    SpinBarrier start(numThreads + 1);
+    SpinBarrier done(numThreads + 1);
+    std::atomic<bool> stop(false);
+    bool quit = false;
+    int iteration = 0;
+    std::vector<std::string> errors(numThreads);
+    uint32_t yieldThreshold = static_cast<uint32_t>(std::min(1.0, std::max(0.0, yieldProbability)) * 4294967295.0);
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < numThreads; t++)
+    {
+      threads.emplace_back([&, t]() {
+        StressContext ctx;
+        ctx.m_ThreadIndex = t;
+        ctx.m_NumThreads = numThreads;
+        ctx.m_YieldThreshold = yieldThreshold;
+        ctx.m_Stop = &stop;
+        while(true)
+        {
+          start.arriveAndWait();
+          if(quit)
+          {
+            break;
+          }
+          ctx.m_Iteration = iteration;
+          ctx.m_Random = SplitMix64(seed ^ (static_cast<uint64_t>(iteration) << 20) ^ static_cast<uint64_t>(t)) | 1;
+          ctx.m_Operations = 0;
+          ctx.m_CountedOperations = false;
+
+          // A small random delay so the threads do not always arrive in the same order
+          for(uint64_t spin = ctx.next() & 0xFF; spin > 0; spin--)
+          {
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+          }
+
+          auto begin = std::chrono::steady_clock::now();
+          try
+          {
+            fn(ctx);
+          } catch(TestException& e)
+          {
+            errors[t] = e.what();
+          } catch(std::exception& e)
+          {
+            errors[t] = std::string("    Exception: ") + e.what();
+          } catch(...)
+          {
+            errors[t] = "    Unknown exception";
+          }
+          if(!errors[t].empty())
+          {
+            stop.store(true, std::memory_order_relaxed);
+          }
+          auto end = std::chrono::steady_clock::now();
+          pass.Seconds[t] += std::chrono::duration<double>(end - begin).count();
+          pass.Operations[t] += ctx.m_CountedOperations ? ctx.m_Operations : 1;
+          done.arriveAndWait();
+        }
+      });
+    }
+
+    for(int i = 0; i < iterations; i++)
+    {
+      iteration = i;
+      stop.store(false, std::memory_order_relaxed);
+      start.arriveAndWait();
+      done.arriveAndWait();
+
+      bool failed = false;
+      for(int t = 0; t < numThreads; t++)
+      {
+        if(!errors[t].empty())
+        {
+          pass.Failures.push_back({i, t, errors[t]});
+          errors[t].clear();
+          failed = true;
+        }
+      }
+      if(verify && !failed)
+      {
+        try
+        {
+          verify(i);
+        } catch(TestException& e)
+        {
+          pass.Failures.push_back({i, -1, e.what()});
+          failed = true;
+        } catch(std::exception& e)
+        {
+          pass.Failures.push_back({i, -1, std::string("    Exception: ") + e.what()});
+          failed = true;
+        } catch(...)
+        {
+          pass.Failures.push_back({i, -1, "    Unknown exception"});
+          failed = true;
+        }
+      }
+      if(failed)
+      {
+        pass.FailedIterations++;
+      }
+    }
+
+    quit = true;
+    start.arriveAndWait();
+    for(std::thread& thread : threads)
+    {
+      thread.join();
+    }
+    return pass;
+  }
+
+  static double OpsPerSecond(const Pass& pass, int t)
+  {
+    return pass.Seconds[t] > 0.0 ? pass.Operations[t] / pass.Seconds[t] : 0.0;
+  }
+};
+
+/**
+ * @brief Parses the --stress-* arguments of the test executable. Unknown
+ * arguments are ignored so this can be handed the complete argument list.
+ */
+inline void ParseStressTestArguments(int argc, char** argv)
+{
+  StressTestOptions& options = GetStressTestOptions();
+  const char* env = ::getenv("SIMPL_STRESS_YIELD");
+  if(nullptr != env)
+  {
+    options.YieldProbability = std::atof(env);
+  }
+  env = ::getenv("SIMPL_STRESS_SEED");
+  if(nullptr != env)
+  {
+    options.Seed = std::strtoull(env, nullptr, 0);
+  }
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if(arg.compare(0, 15, "--stress-yield=") == 0)
+    {
+      options.YieldProbability = std::atof(arg.substr(15).c_str());
+    }
+    else if(arg.compare(0, 20, "--stress-iterations=") == 0)
+    {
+      options.Iterations = std::atoi(arg.substr(20).c_str());
+    }
+    else if(arg.compare(0, 14, "--stress-seed=") == 0)
+    {
+      options.Seed = std::strtoull(arg.substr(14).c_str(), nullptr, 0);
+    }
+  }
+}
+
+/**
+ * @brief Runs 'fn' on 'numThreads' threads (0 uses every hardware thread) that all
+ * start from a barrier, repeats that 'iterations' times and calls 'verify' on the
+ * calling thread after every iteration in which no thread failed. The throughput
+ * is compared against a run of the same function on a single thread. Failures of
+ * all iterations are collected and thrown as a single TestException at the end.
+ * A function that waits on partner threads gives 'minThreads'; it never runs on
+ * fewer threads and the single thread baseline, which would wait forever, is
+ * skipped.
+ */
+inline StressTestResult RunStressTest(const std::string& name, const std::function<void(StressContext&)>& fn, int numThreads, int iterations,
+                                      const std::function<void(int)>& verify = std::function<void(int)>(), int minThreads = 1)
+{
+  StressTestOptions& options = GetStressTestOptions();
+  if(numThreads <= 0)
+  {
+    numThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  minThreads = std::max(1, minThreads);
+  numThreads = std::max(numThreads, minThreads);
+  if(options.Iterations > 0)
+  {
+    iterations = options.Iterations;
+  }
+  iterations = std::max(1, iterations);
+
+  StressTestResult result;
+  result.Threads = numThreads;
+  result.Iterations = iterations;
+  result.Seed = options.Seed;
+  if(0 == result.Seed)
+  {
+    result.Seed = StressRunner::SplitMix64(static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count()));
+  }
+
+  // The single thread baseline, only for the throughput comparison
+  StressRunner::Pass single;
+  if(minThreads == 1)
+  {
+    single = StressRunner::Run(fn, verify, 1, std::min(iterations, 100), result.Seed, 0.0);
+    result.SingleThreadOpsPerSecond = StressRunner::OpsPerSecond(single, 0);
+  }
+
+  StressRunner::Pass pass = StressRunner::Run(fn, verify, numThreads, iterations, result.Seed, options.YieldProbability);
+  result.Failures = pass.Failures;
+  result.FailedIterations = pass.FailedIterations;
+  result.MinOpsPerSecondPerThread = StressRunner::OpsPerSecond(pass, 0);
+  for(int t = 0; t < numThreads; t++)
+  {
+    double ops = StressRunner::OpsPerSecond(pass, t);
+    result.OpsPerSecondPerThread += ops / numThreads;
+    result.MinOpsPerSecondPerThread = std::min(result.MinOpsPerSecondPerThread, ops);
+    result.MaxOpsPerSecondPerThread = std::max(result.MaxOpsPerSecondPerThread, ops);
+  }
+  if(result.SingleThreadOpsPerSecond > 0.0)
+  {
+    result.ScalingLoss = 1.0 - result.OpsPerSecondPerThread / result.SingleThreadOpsPerSecond;
+  }
+
+  std::cout << "  Stress " << name << ": " << numThreads << " threads x " << iterations << " iterations, " << result.FailedIterations << " failed, " << result.OpsPerSecondPerThread
+            << " ops/s per thread (min " << result.MinOpsPerSecondPerThread << ", max " << result.MaxOpsPerSecondPerThread << "), ";
+  if(minThreads == 1)
+  {
+    std::cout << "single thread " << result.SingleThreadOpsPerSecond << " ops/s, scaling loss " << result.ScalingLoss * 100.0 << "%";
+  }
+  else
+  {
+    std::cout << "no single thread baseline (needs " << minThreads << " threads)";
+  }
+  std::cout << ", seed " << result.Seed << "\n";
+
+  if(!single.Failures.empty() || result.FailedIterations > 0)
+  {
+    const std::vector<StressFailure>& failures = result.Failures.empty() ? single.Failures : result.Failures;
+    std::stringstream ss;
+    ss << result.FailedIterations << " of " << iterations << " iterations failed on " << numThreads << " threads (rerun with --stress-seed=" << result.Seed << ")";
+    if(result.Failures.empty())
+    {
+      ss << ", the single thread run failed as well";
+    }
+    for(size_t i = 0; i < failures.size() && i < 5; i++)
+    {
+      ss << "\n  Iteration " << failures[i].Iteration << ", " << (failures[i].Thread < 0 ? std::string("verification") : "thread " + std::to_string(failures[i].Thread)) << ":\n"
+         << failures[i].Message;
+    }
+    if(failures.size() > 5)
+    {
+      ss << "\n  ... and " << failures.size() - 5 << " more failures";
+    }
+    throw TestException(ss.str(), __FILE__, __LINE__);
+  }
+  return result;
+}
+} // namespace unittest
+} // namespace SIMPL
+
+// -----------------------------------------------------------------------------
+// Developer Used Macros
+// -----------------------------------------------------------------------------
+#define DREAM3D_STRESS_TEST(fn, threads, iterations)                                                                                                                                                   \
+  try                                                                                                                                                                                                  \
+  {                                                                                                                                                                                                    \
+    DREAM3D_ENTER_TEST(fn);                                                                                                                                                                            \
+    {                                                                                                                                                                                                  \
+      SIMPL::unittest::TestHookGuard testHookGuard(#fn);                                                                                                                                               \
+      SIMPL::unittest::RunStressTest(#fn, fn, threads, iterations);                                                                                                                                    \
+    }                                                                                                                                                                                                  \
+    DREAM3D_LEAVE_TEST(fn)                                                                                                                                                                             \
+  } catch(TestException & e)                                                                                                                                                                           \
+  {                                                                                                                                                                                                    \
+    TestFailed(SIMPL::unittest::CurrentMethod, e);                                                                                                                                                     \
+    std::cout << e.what() << std::endl;                                                                                                                                                                \
+    err = EXIT_FAILURE;                                                                                                                                                                                \
+  }
+
+// For functions that wait on other threads, e.g. a producer and a consumer: at least minThreads
+// threads and no single thread baseline
+#define DREAM3D_STRESS_TEST_MIN_THREADS(fn, threads, iterations, minThreads)                                                                                                                           \
+  try                                                                                                                                                                                                  \
+  {                                                                                                                                                                                                    \
+    DREAM3D_ENTER_TEST(fn);                                                                                                                                                                            \
+    {                                                                                                                                                                                                  \
+      SIMPL::unittest::TestHookGuard testHookGuard(#fn);                                                                                                                                               \
+      SIMPL::unittest::RunStressTest(#fn, fn, threads, iterations, std::function<void(int)>(), minThreads);                                                                                            \
+    }                                                                                                                                                                                                  \
+    DREAM3D_LEAVE_TEST(fn)                                                                                                                                                                             \
+  } catch(TestException & e)                                                                                                                                                                           \
+  {                                                                                                                                                                                                    \
+    TestFailed(SIMPL::unittest::CurrentMethod, e);                                                                                                                                                     \
+    std::cout << e.what() << std::endl;                                                                                                                                                                \
+    err = EXIT_FAILURE;                                                                                                                                                                                \
+  }
@@ -0,0 +1,421 @@
+/* ============================================================================
+* Copyright (c) 2009-2016 BlueQuartz Software, LLC
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* Redistributions in binary form must reproduce the above copyright notice, this
+* list of conditions and the following disclaimer in the documentation and/or
+* other materials provided with the distribution.
+*
+* Neither the name of BlueQuartz Software, the US Air Force, nor the names of its
+* contributors may be used to endorse or promote products derived from this software
+* without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* The code contained herein was partially funded by the followig contracts:
+*    United States Air Force Prime Contract FA8650-07-D-5800
+*    United States Air Force Prime Contract FA8650-10-D-5210
+*    United States Prime Contract Navy N00173-07-C-2068
+*
+* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+//-- C Includes
+#include <stdint.h>
+#include <stdlib.h>
+
+//-- C++ Includes
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// Synthetic data generation for benchmarks and scale tests.
+//
+// Every value is derived from a Philox4x32-10 counter based generator where the
+// counter is the index of the value inside the buffer and the key is the seed.
+// Any chunk of a buffer can therefore be generated independently of all the
+// others which lets us fill large buffers in parallel and get the exact same
+// bytes regardless of the number of threads or the instruction set in use.
+// -----------------------------------------------------------------------------
+namespace SIMPL
+{
+namespace unittest
+{
+namespace synthetic
+{
+static const uint32_t PhiloxM0 = 0xD2511F53;
+static const uint32_t PhiloxM1 = 0xCD9E8D57;
+static const uint32_t PhiloxW0 = 0x9E3779B9;
+static const uint32_t PhiloxW1 = 0xBB67AE85;
+static const size_t BlockSize = 4; // Number of 32 bit values produced per counter
+static const size_t ChunkBlocks = 256;
+
+/**
+ * @brief Generates one block (4 x 32 bit values) for the given counter and key
+ * using the scalar Philox4x32-10 rounds.
+ */
+inline void PhiloxBlock(uint64_t counter, uint64_t key, uint32_t out[4])
+{
+  uint32_t c0 = static_cast<uint32_t>(counter);
+  uint32_t c1 = static_cast<uint32_t>(counter >> 32);
+  uint32_t c2 = 0;
+  uint32_t c3 = 0;
+  uint32_t k0 = static_cast<uint32_t>(key);
+  uint32_t k1 = static_cast<uint32_t>(key >> 32);
+  for(int r = 0; r < 10; r++)
+  {
+    uint64_t p0 = static_cast<uint64_t>(PhiloxM0) * c0;
+    uint64_t p1 = static_cast<uint64_t>(PhiloxM1) * c2;
+    uint32_t hi0 = static_cast<uint32_t>(p0 >> 32);
+    uint32_t lo0 = static_cast<uint32_t>(p0);
+    uint32_t hi1 = static_cast<uint32_t>(p1 >> 32);
+    uint32_t lo1 = static_cast<uint32_t>(p1);
+    c0 = hi1 ^ c1 ^ k0;
+    c1 = lo1;
+    c2 = hi0 ^ c3 ^ k1;
+    c3 = lo0;
+    k0 += PhiloxW0;
+    k1 += PhiloxW1;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+#if defined(__AVX2__)
+/**
+ * @brief Computes the 32x32->64 bit products of each lane of 'a' with 'm' and
+ * splits them into their high and low halves.
+ */
+inline void PhiloxMulHiLo8(__m256i a, __m256i m, __m256i& hi, __m256i& lo)
+{
+  __m256i even = _mm256_mul_epu32(a, m);
+  __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+  lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+  hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+/**
+ * @brief Generates 8 consecutive blocks starting at 'counter'. The output is
+ * laid out exactly like 8 calls to PhiloxBlock().
+ */
+inline void PhiloxBlock8(uint64_t counter, uint64_t key, uint32_t* out)
+{
+  alignas(32) uint32_t lanes0[8];
+  alignas(32) uint32_t lanes1[8];
+  for(int i = 0; i < 8; i++)
+  {
+    lanes0[i] = static_cast<uint32_t>(counter + i);
+    lanes1[i] = static_cast<uint32_t>((counter + i) >> 32);
+  }
+  __m256i c0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes0));
+  __m256i c1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes1));
+  __m256i c2 = _mm256_setzero_si256();
+  __m256i c3 = _mm256_setzero_si256();
+  const __m256i m0 = _mm256_set1_epi32(static_cast<int>(PhiloxM0));
+  const __m256i m1 = _mm256_set1_epi32(static_cast<int>(PhiloxM1));
+  uint32_t k0 = static_cast<uint32_t>(key);
+  uint32_t k1 = static_cast<uint32_t>(key >> 32);
+  for(int r = 0; r < 10; r++)
+  {
+    __m256i hi0, lo0, hi1, lo1;
+    PhiloxMulHiLo8(c0, m0, hi0, lo0);
+    PhiloxMulHiLo8(c2, m1, hi1, lo1);
+    c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+    c1 = lo1;
+    c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+    c3 = lo0;
+    k0 += PhiloxW0;
+    k1 += PhiloxW1;
+  }
+  // Transpose from "struct of arrays" back to 8 blocks of 4 values
+  __m256i t0 = _mm256_unpacklo_epi32(c0, c1); // b0.0 b0.1 b1.0 b1.1 | b4.0 b4.1 b5.0 b5.1
+  __m256i t1 = _mm256_unpackhi_epi32(c0, c1); // b2.0 b2.1 b3.0 b3.1 | b6.0 b6.1 b7.0 b7.1
+  __m256i t2 = _mm256_unpacklo_epi32(c2, c3);
+  __m256i t3 = _mm256_unpackhi_epi32(c2, c3);
+  __m256i b01 = _mm256_unpacklo_epi64(t0, t2); // b0 | b4
+  __m256i b11 = _mm256_unpackhi_epi64(t0, t2); // b1 | b5
+  __m256i b23 = _mm256_unpacklo_epi64(t1, t3); // b2 | b6
+  __m256i b33 = _mm256_unpackhi_epi64(t1, t3); // b3 | b7
+  __m256i* dst = reinterpret_cast<__m256i*>(out);
+  _mm256_storeu_si256(dst + 0, _mm256_permute2x128_si256(b01, b11, 0x20));
+  _mm256_storeu_si256(dst + 1, _mm256_permute2x128_si256(b23, b33, 0x20));
+  _mm256_storeu_si256(dst + 2, _mm256_permute2x128_si256(b01, b11, 0x31));
+  _mm256_storeu_si256(dst + 3, _mm256_permute2x128_si256(b23, b33, 0x31));
+}
+#endif
+
+/**
+ * @brief Generates 'numBlocks' consecutive blocks starting at 'firstBlock' into
+ * 'out' which must hold at least numBlocks * BlockSize values.
+ */
+inline void GenerateBlocks(uint64_t firstBlock, size_t numBlocks, uint64_t key, uint32_t* out)
+{
+  size_t b = 0;
+#if defined(__AVX2__)
+  for(; b + 8 <= numBlocks; b += 8)
+  {
+    PhiloxBlock8(firstBlock + b, key, out + b * BlockSize);
+  }
+#endif
+  for(; b < numBlocks; b++)
+  {
+    PhiloxBlock(firstBlock + b, key, out + b * BlockSize);
+  }
+}
+
+/**
+ * @brief Converts a random 32 bit value into a float in the range [0, 1)
+ */
+inline float ToUnitFloat(uint32_t r)
+{
+  return static_cast<float>(r >> 8) * (1.0f / 16777216.0f);
+}
+
+// -----------------------------------------------------------------------------
+//
+// -----------------------------------------------------------------------------
+struct AlignedDeleter
+{
+  void operator()(void* ptr) const
+  {
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+  }
+};
+
+/**
+ * @brief Allocates an uninitialized buffer of 'count' elements whose start is
+ * aligned to 'alignment' bytes. The Fill functions of the SyntheticDataGenerator
+ * write straight into buffers like this one.
+ */
+template <typename T> std::unique_ptr<T[], AlignedDeleter> AllocateAligned(size_t count, size_t alignment = 64)
+{
+  void* ptr = nullptr;
+#if defined(_MSC_VER)
+  ptr = _aligned_malloc(count * sizeof(T), alignment);
+#else
+  if(posix_memalign(&ptr, alignment, count * sizeof(T)) != 0)
+  {
+    ptr = nullptr;
+  }
+#endif
+  if(nullptr == ptr)
+  {
+    throw std::bad_alloc();
+  }
+  return std::unique_ptr<T[], AlignedDeleter>(static_cast<T*>(ptr));
+}
+} // namespace synthetic
+
+// -----------------------------------------------------------------------------
+//
+// -----------------------------------------------------------------------------
+class SyntheticDataGenerator
+{
+public:
+  /**
+   * @brief Creates a generator. If the SIMPL_SYNTHETIC_SEED environment variable
+   * is set its value overrides 'seed' so that a failing run can be reproduced.
+   * The seed that is used is printed to std::cout so it shows up in the test output.
+   * @param seed The key for the counter based generator
+   * @param numThreads The number of threads to fill with. Zero uses all cores.
+   */
+  explicit SyntheticDataGenerator(uint64_t seed, unsigned int numThreads = 0)
+  : m_Seed(seed)
+  , m_NumThreads(numThreads)
+  {
+    const char* env = ::getenv("SIMPL_SYNTHETIC_SEED");
+    if(nullptr != env && env[0] != 0)
+    {
+      m_Seed = ::strtoull(env, nullptr, 10);
+    }
+    if(m_NumThreads == 0)
+    {
+      m_NumThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::cout << "Synthetic Data Seed: " << m_Seed << " (set SIMPL_SYNTHETIC_SEED to reproduce)" << std::endl;
+  }
+
+  uint64_t getSeed() const
+  {
+    return m_Seed;
+  }
+
+  unsigned int getNumThreads() const
+  {
+    return m_NumThreads;
+  }
+
+  /**
+   * @brief Fills 'data' with uniformly distributed values in [min, max).
+   * @param offset The index of data[0] inside the complete data set. Passing the
+   * offset of a chunk produces exactly the values the full fill would have put there.
+   */
+  void fillUniform(float* data, size_t count, float min, float max, uint64_t offset = 0) const
+  {
+    const float range = max - min;
+    forEachChunk(count, offset, [=](const uint32_t* rnd, size_t start, size_t n) {
+      for(size_t i = 0; i < n; i++)
+      {
+        data[start + i] = min + range * synthetic::ToUnitFloat(rnd[i]);
+      }
+    });
+  }
+
+  /**
+   * @brief Fills 'data' with normally distributed values using the Box-Muller transform
+   */
+  void fillNormal(float* data, size_t count, float mean, float stddev, uint64_t offset = 0) const
+  {
+    forEachChunk(count, offset, [=](const uint32_t* rnd, size_t start, size_t n) {
+      // Values are produced in pairs so each one is computed from the pair it belongs to.
+      size_t first = (offset + start) & 1;
+      for(size_t i = 0; i < n; i++)
+      {
+        size_t pair = (i + first) & ~static_cast<size_t>(1);
+        const uint32_t* p = rnd + pair - first;
+        float u1 = 1.0f - synthetic::ToUnitFloat(p[0]);
+        float u2 = synthetic::ToUnitFloat(p[1]);
+        float radius = std::sqrt(-2.0f * std::log(u1));
+        float theta = 6.283185307179586f * u2;
+        float z = (((i + first) & 1) == 0) ? radius * std::cos(theta) : radius * std::sin(theta);
+        data[start + i] = mean + stddev * z;
+      }
+    }, 1);
+  }
+
+  /**
+   * @brief Fills 'data' with labels in the range [0, numLabels)
+   */
+  template <typename T> void fillLabels(T* data, size_t count, uint32_t numLabels, uint64_t offset = 0) const
+  {
+    forEachChunk(count, offset, [=](const uint32_t* rnd, size_t start, size_t n) {
+      for(size_t i = 0; i < n; i++)
+      {
+        data[start + i] = static_cast<T>((static_cast<uint64_t>(rnd[i]) * numLabels) >> 32);
+      }
+    });
+  }
+
+  /**
+   * @brief Fills 'quats' with 'numQuats' uniformly distributed unit quaternions
+   * stored as (x, y, z, w) tuples (Shoemake's method).
+   */
+  void fillOrientations(float* quats, size_t numQuats, uint64_t offset = 0) const
+  {
+    // Each quaternion consumes exactly one block of 4 random values
+    forEachChunk(numQuats * synthetic::BlockSize, offset * synthetic::BlockSize, [=](const uint32_t* rnd, size_t start, size_t n) {
+      for(size_t q = 0; q < n / synthetic::BlockSize; q++)
+      {
+        const uint32_t* r = rnd + q * synthetic::BlockSize;
+        float u1 = synthetic::ToUnitFloat(r[0]);
+        float u2 = 6.283185307179586f * synthetic::ToUnitFloat(r[1]);
+        float u3 = 6.283185307179586f * synthetic::ToUnitFloat(r[2]);
+        float a = std::sqrt(1.0f - u1);
+        float b = std::sqrt(u1);
+        float* dst = quats + start + q * synthetic::BlockSize;
+        dst[0] = a * std::sin(u2);
+        dst[1] = a * std::cos(u2);
+        dst[2] = b * std::sin(u3);
+        dst[3] = b * std::cos(u3);
+      }
+    });
+  }
+
+protected:
+  /**
+   * @brief Splits [0, count) into chunks, generates the random values for each
+   * chunk and hands them to 'fn'. Chunks start on block boundaries so a chunk
+   * never needs random values owned by another chunk. 'lookBehind' values in
+   * front of each chunk are also generated for transforms that consume pairs.
+   */
+  template <typename Fn> void forEachChunk(size_t count, uint64_t offset, Fn fn, size_t lookBehind = 0) const
+  {
+    const size_t chunkValues = synthetic::ChunkBlocks * synthetic::BlockSize;
+    const uint64_t seed = m_Seed;
+    auto worker = [=](size_t begin, size_t end) {
+      std::vector<uint32_t> buffer((synthetic::ChunkBlocks + 2) * synthetic::BlockSize);
+      for(size_t start = begin; start < end; start += chunkValues)
+      {
+        size_t n = std::min(chunkValues, end - start);
+        uint64_t firstValue = offset + start;
+        uint64_t padFront = std::min<uint64_t>(lookBehind, firstValue);
+        uint64_t firstBlock = (firstValue - padFront) / synthetic::BlockSize;
+        uint64_t lastBlock = (firstValue + n + lookBehind - 1) / synthetic::BlockSize;
+        size_t numBlocks = static_cast<size_t>(lastBlock - firstBlock + 1);
+        synthetic::GenerateBlocks(firstBlock, numBlocks, seed, buffer.data());
+        size_t skip = static_cast<size_t>(firstValue - firstBlock * synthetic::BlockSize);
+        fn(buffer.data() + skip, start, n);
+      }
+    };
+
+    unsigned int numThreads = m_NumThreads;
+    if(count < chunkValues * 4)
+    {
+      numThreads = 1;
+    }
+    if(numThreads <= 1)
+    {
+      worker(0, count);
+      return;
+    }
+    // Hand out whole chunks so that every thread starts on a block boundary
+    size_t numChunks = (count + chunkValues - 1) / chunkValues;
+    size_t chunksPerThread = (numChunks + numThreads - 1) / numThreads;
+    std::vector<std::thread> threads;
+    for(unsigned int t = 0; t < numThreads; t++)
+    {
+      size_t begin = t * chunksPerThread * chunkValues;
+      size_t end = std::min(count, begin + chunksPerThread * chunkValues);
+      if(begin >= end)
+      {
+        break;
+      }
+      threads.push_back(std::thread(worker, begin, end));
+    }
+    for(auto& thread : threads)
+    {
+      thread.join();
+    }
+  }
+
+private:
+  uint64_t m_Seed;
+  unsigned int m_NumThreads;
+};
+} // namespace unittest
+} // namespace SIMPL
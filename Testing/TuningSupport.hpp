@@ -0,0 +1,429 @@
+/* ============================================================================
+* Copyright (c) 2009-2016 BlueQuartz Software, LLC
+*
+* Redistribution and use in source and binary forms, with or without modification,
+* are permitted provided that the following conditions are met:
+*
+* Redistributions of source code must retain the above copyright notice, this
+* list of conditions and the following disclaimer.
+*
+* Redistributions in binary form must reproduce the above copyright notice, this
+* list of conditions and the following disclaimer in the documentation and/or
+* other materials provided with the distribution.
+*
+* Neither the name of BlueQuartz Software, the US Air Force, nor the names of its
+* contributors may be used to endorse or promote products derived from this software
+* without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+* AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+* IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+* DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+* FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+* DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+* SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+* CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+* USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*
+* The code contained herein was partially funded by the followig contracts:
+*    United States Air Force Prime Contract FA8650-07-D-5800
+*    United States Air Force Prime Contract FA8650-10-D-5210
+*    United States Prime Contract Navy N00173-07-C-2068
+*
+* ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+#pragma once
+
+//-- C Includes
+#include <stdint.h>
+#include <stdlib.h>
+
+//-- C++ Includes
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BenchmarkSupport.hpp"
+#include "UnitTestSupport.hpp"
+
+// -----------------------------------------------------------------------------
+// Searches the block sizes, grain sizes and tile dimensions of a kernel on the
+// machine that builds it. A tuning test declares the candidate values of every
+// parameter, starting from the constants the code currently uses:
+//
+//   SIMPL::unittest::TuningSpace space;
+//   space.add("BlockSize", {16, 32, 64, 128}, cmp::tuned::Convolution::BlockSize);
+//   space.add("GrainSize", {256, 1024, 4096, 16384}, cmp::tuned::Convolution::GrainSize);
+//   DREAM3D_REGISTER_TUNING(Convolution, space, [&](const SIMPL::unittest::TuningPoint& p) { Convolve(image, p.at("BlockSize"), p.at("GrainSize")); })
+//
+// Without a tuning directory the kernel runs once with the current values, as a
+// plain test. With --tune-dir= (or SIMPL_TUNING_DIR, set by the TUNE target) the
+// space is searched and the winners are written to <dir>/Convolution.cmake as
+// CMP_TUNED_Convolution_BlockSize and friends, which cmpConfigureTunedConstants()
+// turns into the constants of a generated header.
+// -----------------------------------------------------------------------------
+namespace SIMPL
+{
+namespace unittest
+{
+struct TuningOptions
+{
+  std::string Directory;            // --tune-dir=path (or SIMPL_TUNING_DIR), empty does not tune
+  std::string Strategy = "descent"; // --tune-strategy=descent|grid
+  int Repeats = 5;                  // --tune-repeats=N, timed runs per measured point
+  double NoisePercent = 2.0;        // --tune-noise-pct=P, smallest speedup that moves away from the current point
+};
+
+inline TuningOptions& GetTuningOptions()
+{
+  static TuningOptions options;
+  return options;
+}
+
+typedef std::map<std::string, int64_t> TuningPoint;
+
+/**
+ * @brief The tunable parameters of one kernel: the candidate values of each
+ * and the value the code currently uses, which is where the search starts.
+ */
+class TuningSpace
+{
+public:
+  struct Parameter
+  {
+    std::string Name;
+    std::vector<int64_t> Values;
+    int64_t Current = 0;
+  };
+
+  void add(const std::string& name, std::vector<int64_t> values, int64_t current)
+  {
+    if(std::find(values.begin(), values.end(), current) == values.end())
+    {
+      values.push_back(current);
+    }
+    std::sort(values.begin(), values.end());
+    Parameter parameter;
+    parameter.Name = name;
+    parameter.Values = values;
+    parameter.Current = current;
+    m_Parameters.push_back(parameter);
+  }
+
+  const std::vector<Parameter>& parameters() const
+  {
+    return m_Parameters;
+  }
+
+  TuningPoint current() const
+  {
+    TuningPoint point;
+    for(const Parameter& parameter : m_Parameters)
+    {
+      point[parameter.Name] = parameter.Current;
+    }
+    return point;
+  }
+
+private:
+  std::vector<Parameter> m_Parameters;
+};
+
+namespace tuning
+{
+/**
+ * @brief Median run time of one point and its noise, the median absolute
+ * deviation relative to the median.
+ */
+struct Measurement
+{
+  double Median = 0.0;
+  double Noise = 0.0;
+  std::vector<double> Seconds;
+
+  void update()
+  {
+    Median = benchmark::Median(Seconds);
+    std::vector<double> deviations;
+    for(double s : Seconds)
+    {
+      deviations.push_back(std::fabs(s - Median));
+    }
+    Noise = Median > 0.0 ? benchmark::Median(deviations) / Median : 0.0;
+  }
+};
+
+inline std::string PointToString(const TuningPoint& point)
+{
+  std::stringstream ss;
+  for(const auto& value : point)
+  {
+    ss << (ss.tellp() > 0 ? " " : "") << value.first << "=" << value.second;
+  }
+  return ss.str();
+}
+
+/**
+ * @brief A candidate only replaces the incumbent when it is faster by more than
+ * --tune-noise-pct and by more than the noise of both measurements together, so
+ * run to run jitter does not move the constants back and forth between builds.
+ */
+inline bool IsFaster(const Measurement& candidate, const Measurement& incumbent)
+{
+  double threshold = std::max(GetTuningOptions().NoisePercent / 100.0, candidate.Noise + incumbent.Noise);
+  return candidate.Median < incumbent.Median * (1.0 - threshold);
+}
+
+class Search
+{
+public:
+  Search(const TuningSpace& space, const std::function<void(const TuningPoint&)>& fn)
+  : m_Space(space)
+  , m_Function(fn)
+  {
+  }
+
+  /**
+   * @brief Times --tune-repeats runs of the point after one warm up run. Every
+   * point is measured once; the search only compares measured points.
+   */
+  const Measurement& measure(const TuningPoint& point)
+  {
+    auto found = m_Measured.find(point);
+    if(found != m_Measured.end())
+    {
+      return found->second;
+    }
+    Measurement& measurement = m_Measured[point];
+    m_Function(point);
+    for(int i = 0; i < GetTuningOptions().Repeats; i++)
+    {
+      auto start = std::chrono::steady_clock::now();
+      m_Function(point);
+      auto stop = std::chrono::steady_clock::now();
+      measurement.Seconds.push_back(std::chrono::duration<double>(stop - start).count());
+    }
+    measurement.update();
+    std::cout << "    " << PointToString(point) << ": median " << measurement.Median * 1000.0 << " ms, noise " << measurement.Noise * 100.0 << "%\n";
+    return measurement;
+  }
+
+  /**
+   * @brief Changes one parameter at a time to the best of its values while the
+   * others stay fixed, until a full pass over the parameters moves nothing.
+   */
+  TuningPoint descent()
+  {
+    TuningPoint best = m_Space.current();
+    bool moved = true;
+    for(int pass = 0; moved && pass < 10; pass++)
+    {
+      moved = false;
+      for(const TuningSpace::Parameter& parameter : m_Space.parameters())
+      {
+        TuningPoint incumbent = best;
+        for(int64_t value : parameter.Values)
+        {
+          TuningPoint candidate = incumbent;
+          candidate[parameter.Name] = value;
+          if(candidate != best && IsFaster(measure(candidate), measure(best)))
+          {
+            best = candidate;
+          }
+        }
+        moved = moved || best != incumbent;
+      }
+    }
+    return best;
+  }
+
+  /**
+   * @brief Measures every combination of the values.
+   */
+  TuningPoint grid()
+  {
+    TuningPoint best = m_Space.current();
+    const std::vector<TuningSpace::Parameter>& parameters = m_Space.parameters();
+    std::vector<size_t> index(parameters.size(), 0);
+    while(!parameters.empty())
+    {
+      TuningPoint candidate;
+      for(size_t i = 0; i < parameters.size(); i++)
+      {
+        candidate[parameters[i].Name] = parameters[i].Values[index[i]];
+      }
+      if(candidate != best && IsFaster(measure(candidate), measure(best)))
+      {
+        best = candidate;
+      }
+      size_t i = 0;
+      while(i < index.size() && ++index[i] == parameters[i].Values.size())
+      {
+        index[i++] = 0;
+      }
+      if(i == index.size())
+      {
+        break;
+      }
+    }
+    return best;
+  }
+
+  /**
+   * @brief Times the winner and the current point again, alternating between the
+   * two so a drift of the clock or of the machine load hits both alike. Returns
+   * false if the winner no longer beats the current point.
+   */
+  bool confirm(const TuningPoint& winner, Measurement& winnerTime, Measurement& currentTime)
+  {
+    TuningPoint current = m_Space.current();
+    for(int i = 0; i < GetTuningOptions().Repeats; i++)
+    {
+      for(int which = 0; which < 2; which++)
+      {
+        bool runWinner = (i + which) % 2 == 0;
+        auto start = std::chrono::steady_clock::now();
+        m_Function(runWinner ? winner : current);
+        auto stop = std::chrono::steady_clock::now();
+        (runWinner ? winnerTime : currentTime).Seconds.push_back(std::chrono::duration<double>(stop - start).count());
+      }
+    }
+    winnerTime.update();
+    currentTime.update();
+    return IsFaster(winnerTime, currentTime);
+  }
+
+  size_t measuredPoints() const
+  {
+    return m_Measured.size();
+  }
+
+private:
+  const TuningSpace& m_Space;
+  std::function<void(const TuningPoint&)> m_Function;
+  std::map<TuningPoint, Measurement> m_Measured;
+};
+
+/**
+ * @brief Writes the winners as CMake variables for cmpConfigureTunedConstants().
+ * The comment lines tell where and when they were measured.
+ */
+inline void WriteResults(const std::string& name, const TuningSpace& space, const TuningPoint& winner, const Measurement& winnerTime, const Measurement& currentTime)
+{
+  std::string filePath = GetTuningOptions().Directory + "/" + name + ".cmake";
+  std::ofstream out(filePath.c_str(), std::ios::trunc);
+  if(!out.is_open())
+  {
+    throw TestException("Could not write the tuning results to " + filePath, __FILE__, __LINE__);
+  }
+  out << "# Tuned on " << HostName() << " at " << ReportTimestamp() << " with the " << GetTuningOptions().Strategy << " strategy\n";
+  out << "# Started from " << PointToString(space.current()) << ": median " << currentTime.Median * 1000.0 << " ms\n";
+  out << "# Tuned to " << PointToString(winner) << ": median " << winnerTime.Median * 1000.0 << " ms\n";
+  for(const auto& value : winner)
+  {
+    out << "set(CMP_TUNED_" << name << "_" << value.first << " " << value.second << ")\n";
+  }
+  std::cout << "    Wrote " << filePath << "\n";
+}
+} // namespace tuning
+
+inline void ParseTuningArguments(int argc, char** argv)
+{
+  TuningOptions& options = GetTuningOptions();
+  const char* directory = ::getenv("SIMPL_TUNING_DIR");
+  if(nullptr != directory)
+  {
+    options.Directory = directory;
+  }
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if(arg.compare(0, 11, "--tune-dir=") == 0)
+    {
+      options.Directory = arg.substr(11);
+    }
+    else if(arg.compare(0, 16, "--tune-strategy=") == 0)
+    {
+      options.Strategy = arg.substr(16);
+    }
+    else if(arg.compare(0, 15, "--tune-repeats=") == 0)
+    {
+      options.Repeats = std::max(3, std::atoi(arg.substr(15).c_str()));
+    }
+    else if(arg.compare(0, 17, "--tune-noise-pct=") == 0)
+    {
+      options.NoisePercent = std::max(0.0, std::atof(arg.substr(17).c_str()));
+    }
+  }
+}
+
+/**
+ * @brief Runs 'fn' once with the current values of 'space'. With a tuning
+ * directory it then searches the space with coordinate descent or the full
+ * grid, confirms the winner against the current values and writes it to
+ * <directory>/<name>.cmake. A winner that does not hold up keeps the current
+ * values, so an unchanged kernel does not change the generated header.
+ */
+inline void RunTuning(const std::string& name, const TuningSpace& space, const std::function<void(const TuningPoint&)>& fn)
+{
+  const TuningOptions& options = GetTuningOptions();
+  if(options.Directory.empty())
+  {
+    fn(space.current());
+    return;
+  }
+  if(options.Strategy != "descent" && options.Strategy != "grid")
+  {
+    throw TestException("Unknown --tune-strategy=" + options.Strategy + ", use descent or grid", __FILE__, __LINE__);
+  }
+
+  std::cout << "  Tuning " << name << " (" << options.Strategy << ", " << options.Repeats << " runs per point)\n";
+  tuning::Search search(space, fn);
+  TuningPoint winner = options.Strategy == "grid" ? search.grid() : search.descent();
+  tuning::Measurement winnerTime = search.measure(winner);
+  tuning::Measurement currentTime = search.measure(space.current());
+  if(winner != space.current())
+  {
+    winnerTime = tuning::Measurement();
+    currentTime = tuning::Measurement();
+    if(!search.confirm(winner, winnerTime, currentTime))
+    {
+      std::cout << "    " << tuning::PointToString(winner) << " did not hold up against the current values when measured again\n";
+      winner = space.current();
+      winnerTime = currentTime;
+    }
+  }
+  std::cout << "  Tuning " << name << ": " << tuning::PointToString(winner) << ", median " << winnerTime.Median * 1000.0 << " ms (current values " << currentTime.Median * 1000.0 << " ms), "
+            << search.measuredPoints() << " points measured\n";
+  tuning::WriteResults(name, space, winner, winnerTime, currentTime);
+}
+} // namespace unittest
+} // namespace SIMPL
+
+// -----------------------------------------------------------------------------
+// Developer Used Macros
+// -----------------------------------------------------------------------------
+#define DREAM3D_REGISTER_TUNING(name, space, fn)                                                                                                                                                       \
+  try                                                                                                                                                                                                  \
+  {                                                                                                                                                                                                    \
+    DREAM3D_ENTER_TEST(name);                                                                                                                                                                          \
+    {                                                                                                                                                                                                  \
+      SIMPL::unittest::TestHookGuard testHookGuard(#name);                                                                                                                                             \
+      SIMPL::unittest::RunTuning(#name, space, fn);                                                                                                                                                    \
+    }                                                                                                                                                                                                  \
+    DREAM3D_LEAVE_TEST(name)                                                                                                                                                                           \
+  } catch(TestException & e)                                                                                                                                                                           \
+  {                                                                                                                                                                                                    \
+    TestFailed(SIMPL::unittest::CurrentMethod, e);                                                                                                                                                     \
+    std::cout << e.what() << std::endl;                                                                                                                                                                \
+    err = EXIT_FAILURE;                                                                                                                                                                                \
+  }
@@ -37,12 +37,22 @@
 
 //-- C Includes
 #include <assert.h>
+#include <time.h>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
 
 //-- C++ Includes
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 #include <string.h>
 #include <string>
+#include <vector>
 
 #define NUM_COLS 120
 
@@ -63,6 +73,126 @@ static const char Passed[6] = {'P', 'A', 'S', 'S', 'E', 'D'};
 static const char Failed[6] = {'F', 'A', 'I', 'L', 'E', 'D'};
 static int SizeOfPassed = 6;
 static int SizeOfFailed = 6;
+
+/* Called before and after every DREAM3D_REGISTER_TEST run, e.g. by the sampling
+ * profiler of ProfilerSupport.hpp or the tracing of cmpTrace.h. The finished
+ * hooks run in reverse order. */
+typedef void (*TestHook)(const std::string& testName);
+static std::vector<TestHook> TestStartedHooks;
+static std::vector<TestHook> TestFinishedHooks;
+
+/**
+ * @brief Calls the test hooks, the finished hook also when the test throws
+ */
+class TestHookGuard
+{
+public:
+  explicit TestHookGuard(const char* testName)
+  : m_TestName(testName)
+  {
+    for(TestHook hook : TestStartedHooks)
+    {
+      hook(m_TestName);
+    }
+  }
+  ~TestHookGuard()
+  {
+    for(std::vector<TestHook>::reverse_iterator hook = TestFinishedHooks.rbegin(); hook != TestFinishedHooks.rend(); ++hook)
+    {
+      (*hook)(m_TestName);
+    }
+  }
+
+private:
+  std::string m_TestName;
+};
+
+// -----------------------------------------------------------------------------
+// Per test timing and results for the JUnit XML and JSON reports
+// -----------------------------------------------------------------------------
+struct TestReportOptions
+{
+  std::string JUnitFile;    // --report-junit=FILE
+  std::string JsonFile;     // --report-json=FILE (with SIMPL_TEST_REPORT_DIR both default to <dir>/<executable>.xml/.json)
+  std::string SuiteName;    // The name of the test executable
+  int SlowestCount = 10;    // --report-slowest=N, tests listed in the summary
+};
+
+inline TestReportOptions& GetTestReportOptions()
+{
+  static TestReportOptions options;
+  return options;
+}
+
+struct TestRecord
+{
+  std::string Name;
+  bool Passed = false;
+  double WallSeconds = 0.0;
+  double CpuSeconds = 0.0; // Of the whole process, so the worker threads of a test count as well
+  std::string Message;
+  std::string FileName;
+  int LineNumber = 0;
+};
+
+inline std::vector<TestRecord>& TestRecords()
+{
+  static std::vector<TestRecord> records;
+  return records;
+}
+
+/* CPU time of the process; the Windows C runtime only offers wall time here */
+inline double ProcessCpuSeconds()
+{
+#if defined(CLOCK_PROCESS_CPUTIME_ID)
+  struct timespec ts;
+  if(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == 0)
+  {
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) * 1.0e-9;
+  }
+#endif
+  return static_cast<double>(clock()) / CLOCKS_PER_SEC;
+}
+
+struct RunningTest
+{
+  std::string Name;
+  std::chrono::steady_clock::time_point Start;
+  double CpuStart = 0.0;
+};
+
+inline RunningTest& CurrentTestTiming()
+{
+  static RunningTest running;
+  return running;
+}
+
+/* Called by DREAM3D_ENTER_TEST */
+inline void BeginTestRecord(const std::string& name)
+{
+  RunningTest& running = CurrentTestTiming();
+  running.Name = name;
+  running.Start = std::chrono::steady_clock::now();
+  running.CpuStart = ProcessCpuSeconds();
+}
+
+/* Called by TestPassed()/TestFailed(); a test that was not started through
+ * DREAM3D_ENTER_TEST is recorded without times */
+inline TestRecord& EndTestRecord(const std::string& name, bool passed)
+{
+  RunningTest& running = CurrentTestTiming();
+  TestRecord record;
+  record.Name = name;
+  record.Passed = passed;
+  if(running.Name == name)
+  {
+    record.WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - running.Start).count();
+    record.CpuSeconds = ProcessCpuSeconds() - running.CpuStart;
+    running.Name.clear();
+  }
+  TestRecords().push_back(record);
+  return TestRecords().back();
+}
 }
 }
 
@@ -197,8 +327,10 @@ void TestPassed(const std::string& test)
     ::strncpy(SIMPL::unittest::TestMessage, test.substr(0, size).c_str(), size);
   }
   SIMPL::unittest::TestMessage[NUM_COLS] = 0; // Make sure it is null terminated
-  std::cout << SIMPL::unittest::TestMessage << std::endl;
+  // Passed lines stay in the stream buffer, failures and the summary flush it
+  std::cout << SIMPL::unittest::TestMessage << '\n';
   SIMPL::unittest::numTestsPass++;
+  SIMPL::unittest::EndTestRecord(test, true);
 }
 
 // -----------------------------------------------------------------------------
@@ -222,6 +354,258 @@ void TestFailed(const std::string& test)
   SIMPL::unittest::TestMessage[NUM_COLS] = 0; // Make sure it is null terminated
   std::cout << SIMPL::unittest::TestMessage << std::endl;
   SIMPL::unittest::numTestFailed++;
+  SIMPL::unittest::EndTestRecord(test, false);
+}
+
+// -----------------------------------------------------------------------------
+//
+// -----------------------------------------------------------------------------
+void TestFailed(const std::string& test, const TestException& e)
+{
+  TestFailed(test);
+  SIMPL::unittest::TestRecord& record = SIMPL::unittest::TestRecords().back();
+  record.Message = e.getMessage();
+  record.FileName = e.getFileName();
+  record.LineNumber = e.getLineNumber();
+}
+
+namespace SIMPL
+{
+namespace unittest
+{
+inline std::string HostName()
+{
+#if defined(_WIN32)
+  const char* name = ::getenv("COMPUTERNAME");
+  return nullptr != name ? name : "";
+#else
+  char name[256] = {0};
+  if(::gethostname(name, sizeof(name) - 1) != 0)
+  {
+    return "";
+  }
+  return name;
+#endif
+}
+
+inline std::string XmlEscape(const std::string& value)
+{
+  std::string out;
+  for(char c : value)
+  {
+    switch(c)
+    {
+    case '&':
+      out += "&amp;";
+      break;
+    case '<':
+      out += "&lt;";
+      break;
+    case '>':
+      out += "&gt;";
+      break;
+    case '"':
+      out += "&quot;";
+      break;
+    case '\n':
+      out += "&#10;";
+      break;
+    default:
+      out += c;
+    }
+  }
+  return out;
+}
+
+inline std::string JsonEscape(const std::string& value)
+{
+  std::string out;
+  for(char c : value)
+  {
+    switch(c)
+    {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if(static_cast<unsigned char>(c) >= 0x20)
+      {
+        out += c;
+      }
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief Parses the --report-* arguments of the test executable. Unknown
+ * arguments are ignored so this can be handed the complete argument list.
+ */
+inline void ParseTestReportArguments(int argc, char** argv)
+{
+  TestReportOptions& options = GetTestReportOptions();
+  if(argc > 0)
+  {
+    std::string name(argv[0]);
+    std::string::size_type slash = name.find_last_of("/\\");
+    if(slash != std::string::npos)
+    {
+      name = name.substr(slash + 1);
+    }
+    if(name.size() > 4 && name.compare(name.size() - 4, 4, ".exe") == 0)
+    {
+      name = name.substr(0, name.size() - 4);
+    }
+    options.SuiteName = name;
+  }
+  const char* env = ::getenv("SIMPL_TEST_REPORT_DIR");
+  if(nullptr != env && env[0] != 0)
+  {
+    options.JUnitFile = std::string(env) + "/" + options.SuiteName + ".xml";
+    options.JsonFile = std::string(env) + "/" + options.SuiteName + ".json";
+  }
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if(arg.compare(0, 15, "--report-junit=") == 0)
+    {
+      options.JUnitFile = arg.substr(15);
+    }
+    else if(arg.compare(0, 14, "--report-json=") == 0)
+    {
+      options.JsonFile = arg.substr(14);
+    }
+    else if(arg.compare(0, 17, "--report-slowest=") == 0)
+    {
+      options.SlowestCount = std::atoi(arg.substr(17).c_str());
+    }
+  }
+}
+
+/**
+ * @brief Prints the --report-slowest tests with their wall and CPU times
+ */
+inline void PrintSlowestTests(std::ostream& out)
+{
+  std::vector<TestRecord> records = TestRecords();
+  const int count = std::min(static_cast<int>(records.size()), GetTestReportOptions().SlowestCount);
+  if(count <= 0)
+  {
+    return;
+  }
+  std::stable_sort(records.begin(), records.end(), [](const TestRecord& a, const TestRecord& b) { return a.WallSeconds > b.WallSeconds; });
+  double total = 0.0;
+  for(const TestRecord& record : records)
+  {
+    total += record.WallSeconds;
+  }
+  // Restored at the end, the caller keeps printing to 'out'
+  const std::ios::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision();
+  out << "  " << count << " slowest tests (" << std::fixed << std::setprecision(3) << total << " s in all tests):\n";
+  for(int i = 0; i < count; i++)
+  {
+    out << "    " << std::setw(10) << records[i].WallSeconds << " s wall " << std::setw(10) << records[i].CpuSeconds << " s cpu  " << records[i].Name << (records[i].Passed ? "" : " (FAILED)") << "\n";
+  }
+  out.flags(flags);
+  out.precision(precision);
+}
+
+inline std::string ReportTimestamp()
+{
+  time_t now = ::time(nullptr);
+  struct tm utc;
+#if defined(_WIN32)
+  gmtime_s(&utc, &now);
+#else
+  gmtime_r(&now, &utc);
+#endif
+  char buffer[32] = {0};
+  strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", &utc);
+  return buffer;
+}
+
+/**
+ * @brief Writes the JUnit XML and JSON reports that were asked for on the
+ * command line. Returns false if one of them could not be written.
+ */
+inline bool WriteTestReports()
+{
+  const TestReportOptions& options = GetTestReportOptions();
+  const std::vector<TestRecord>& records = TestRecords();
+  int failures = 0;
+  double wall = 0.0;
+  double cpu = 0.0;
+  for(const TestRecord& record : records)
+  {
+    failures += record.Passed ? 0 : 1;
+    wall += record.WallSeconds;
+    cpu += record.CpuSeconds;
+  }
+  const std::string host = HostName();
+  const std::string timestamp = ReportTimestamp();
+  bool ok = true;
+
+  if(!options.JUnitFile.empty())
+  {
+    std::ofstream out(options.JUnitFile.c_str(), std::ios::out | std::ios::trunc);
+    out << std::fixed << std::setprecision(6);
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    out << "<testsuites tests=\"" << records.size() << "\" failures=\"" << failures << "\" time=\"" << wall << "\">\n";
+    out << "  <testsuite name=\"" << XmlEscape(options.SuiteName) << "\" tests=\"" << records.size() << "\" failures=\"" << failures << "\" errors=\"0\" skipped=\"0\" time=\"" << wall
+        << "\" timestamp=\"" << timestamp << "\" hostname=\"" << XmlEscape(host) << "\">\n";
+    for(const TestRecord& record : records)
+    {
+      out << "    <testcase name=\"" << XmlEscape(record.Name) << "\" classname=\"" << XmlEscape(options.SuiteName) << "\" time=\"" << record.WallSeconds << "\"";
+      if(!record.FileName.empty())
+      {
+        out << " file=\"" << XmlEscape(record.FileName) << "\" line=\"" << record.LineNumber << "\"";
+      }
+      out << ">\n";
+      out << "      <properties><property name=\"cpu_time\" value=\"" << record.CpuSeconds << "\"/></properties>\n";
+      if(!record.Passed)
+      {
+        out << "      <failure message=\"" << XmlEscape(record.Message) << "\" type=\"TestException\">" << XmlEscape(record.FileName) << ":" << record.LineNumber << "\n"
+            << XmlEscape(record.Message) << "</failure>\n";
+      }
+      out << "    </testcase>\n";
+    }
+    out << "  </testsuite>\n</testsuites>\n";
+    ok = ok && out.good();
+  }
+
+  if(!options.JsonFile.empty())
+  {
+    std::ofstream out(options.JsonFile.c_str(), std::ios::out | std::ios::trunc);
+    out << std::setprecision(9);
+    out << "{\"suite\":\"" << JsonEscape(options.SuiteName) << "\",\"host\":\"" << JsonEscape(host) << "\",\"timestamp\":\"" << timestamp << "\",\"tests\":" << records.size()
+        << ",\"failures\":" << failures << ",\"wall_s\":" << wall << ",\"cpu_s\":" << cpu << ",\"results\":[";
+    for(size_t i = 0; i < records.size(); i++)
+    {
+      const TestRecord& record = records[i];
+      out << (i > 0 ? ",\n" : "\n") << "{\"name\":\"" << JsonEscape(record.Name) << "\",\"status\":\"" << (record.Passed ? "passed" : "failed") << "\",\"wall_s\":" << record.WallSeconds
+          << ",\"cpu_s\":" << record.CpuSeconds;
+      if(!record.Passed)
+      {
+        out << ",\"message\":\"" << JsonEscape(record.Message) << "\",\"file\":\"" << JsonEscape(record.FileName) << "\",\"line\":" << record.LineNumber;
+      }
+      out << "}";
+    }
+    out << "\n]}\n";
+    ok = ok && out.good();
+  }
+  return ok;
+}
+}
 }
 
 // -----------------------------------------------------------------------------
@@ -490,7 +874,8 @@ bool AlmostEqualUlpsFinal(float* A, float* B, int maxUlps)
 
 #define DREAM3D_ENTER_TEST(test)                                                                                                                                                                       \
   SIMPL::unittest::CurrentMethod = #test;                                                                                                                                                              \
-  SIMPL::unittest::numTests++;
+  SIMPL::unittest::numTests++;                                                                                                                                                                         \
+  SIMPL::unittest::BeginTestRecord(#test);
 
 #define DREAM3D_LEAVE_TEST(test)                                                                                                                                                                       \
   TestPassed(#test);                                                                                                                                                                                   \
@@ -500,20 +885,30 @@ bool AlmostEqualUlpsFinal(float* A, float* B, int maxUlps)
   try                                                                                                                                                                                                  \
   {                                                                                                                                                                                                    \
     DREAM3D_ENTER_TEST(test);                                                                                                                                                                          \
-    test;                                                                                                                                                                                              \
+    {                                                                                                                                                                                                  \
+      SIMPL::unittest::TestHookGuard testHookGuard(#test);                                                                                                                                             \
+      test;                                                                                                                                                                                            \
+    }                                                                                                                                                                                                  \
     DREAM3D_LEAVE_TEST(test)                                                                                                                                                                           \
   } catch(TestException & e)                                                                                                                                                                           \
   {                                                                                                                                                                                                    \
-    TestFailed(SIMPL::unittest::CurrentMethod);                                                                                                                                                        \
+    TestFailed(SIMPL::unittest::CurrentMethod, e);                                                                                                                                                     \
     std::cout << e.what() << std::endl;                                                                                                                                                                \
     err = EXIT_FAILURE;                                                                                                                                                                                \
   }
 
 #define PRINT_TEST_SUMMARY()                                                                                                                                                                           \
-  std::cout << "Test Summary:" << std::endl;                                                                                                                                                           \
-  std::cout << "  Tests Passed: " << SIMPL::unittest::numTestsPass << std::endl;                                                                                                                       \
-  std::cout << "  Tests Failed: " << SIMPL::unittest::numTestFailed << std::endl;                                                                                                                      \
-  std::cout << "  Total Tests:  " << SIMPL::unittest::numTests << std::endl;                                                                                                                           \
+  std::cout << "Test Summary:" << "\n";                                                                                                                                                                \
+  std::cout << "  Tests Passed: " << SIMPL::unittest::numTestsPass << "\n";                                                                                                                            \
+  std::cout << "  Tests Failed: " << SIMPL::unittest::numTestFailed << "\n";                                                                                                                           \
+  std::cout << "  Total Tests:  " << SIMPL::unittest::numTests << "\n";                                                                                                                                \
+  SIMPL::unittest::PrintSlowestTests(std::cout);                                                                                                                                                       \
+  std::cout << std::flush;                                                                                                                                                                             \
+  if(!SIMPL::unittest::WriteTestReports())                                                                                                                                                             \
+  {                                                                                                                                                                                                    \
+    std::cout << "Could not write the test reports" << std::endl;                                                                                                                                      \
+    err = EXIT_FAILURE;                                                                                                                                                                                \
+  }                                                                                                                                                                                                    \
   if(SIMPL::unittest::numTestFailed > 0)                                                                                                                                                               \
   {                                                                                                                                                                                                    \
     err = EXIT_FAILURE;                                                                                                                                                                                \
@@ -0,0 +1,77 @@
+#-------------------------------------------------------------------------------
+# Helpers of the CMP scripts that read the JSON lines the benchmarks of the
+# unit tests write with --bench-results=, see BenchmarkSupport.hpp.
+#-------------------------------------------------------------------------------
+
+#-------------------------------------------------------------------------------
+# CMake only has integer math, so times are kept in nanoseconds. Converts the
+# seconds the benchmark reports, e.g. 0.0123 or 1.23e-05, into nanoseconds.
+function(_cmpSecondsToNs seconds var)
+  set(exponent 0)
+  if(seconds MATCHES "^([^eE]*)[eE]([-+]?[0-9]+)$")
+    set(seconds "${CMAKE_MATCH_1}")
+    math(EXPR exponent "${CMAKE_MATCH_2}")
+  endif()
+  set(whole "${seconds}")
+  set(fraction "")
+  if(seconds MATCHES "^([0-9]*)\\.([0-9]*)$")
+    set(whole "${CMAKE_MATCH_1}")
+    set(fraction "${CMAKE_MATCH_2}")
+  endif()
+  # Move the decimal point 9 + exponent digits to the right
+  math(EXPR shift "9 + ${exponent}")
+  set(digits "${whole}${fraction}000000000000000000")
+  string(LENGTH "${whole}" wholeLength)
+  math(EXPR length "${wholeLength} + ${shift}")
+  if(length LESS 1)
+    set(${var} 0 PARENT_SCOPE)
+    return()
+  endif()
+  string(SUBSTRING "${digits}" 0 ${length} digits)
+  string(REGEX REPLACE "^0+" "" digits "${digits}")
+  if("${digits}" STREQUAL "")
+    set(digits 0)
+  endif()
+  set(${var} ${digits} PARENT_SCOPE)
+endfunction()
+
+# Formats nanoseconds as milliseconds with three decimals
+function(_cmpFormatNs ns var)
+  if("${ns}" STREQUAL "")
+    set(${var} "-" PARENT_SCOPE)
+    return()
+  endif()
+  math(EXPR us "(${ns} + 500) / 1000")
+  math(EXPR ms "${us} / 1000")
+  math(EXPR rest "${us} % 1000 + 1000")
+  string(SUBSTRING "${rest}" 1 3 rest)
+  set(${var} "${ms}.${rest} ms" PARENT_SCOPE)
+endfunction()
+
+# Median of a list of nanoseconds; list(SORT) would compare the numbers as strings
+function(_cmpMedianNs values var)
+  set(sorted "")
+  foreach(value ${values})
+    set(inserted FALSE)
+    set(next "")
+    foreach(other ${sorted})
+      if(NOT inserted AND value LESS other)
+        list(APPEND next ${value})
+        set(inserted TRUE)
+      endif()
+      list(APPEND next ${other})
+    endforeach()
+    if(NOT inserted)
+      list(APPEND next ${value})
+    endif()
+    set(sorted ${next})
+  endforeach()
+  list(LENGTH sorted count)
+  if(count EQUAL 0)
+    set(${var} "" PARENT_SCOPE)
+    return()
+  endif()
+  math(EXPR middle "${count} / 2")
+  list(GET sorted ${middle} median)
+  set(${var} ${median} PARENT_SCOPE)
+endfunction()
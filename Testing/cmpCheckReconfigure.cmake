@@ -0,0 +1,131 @@
+#-------------------------------------------------------------------------------
+# Checks that configuring a build directory again does not rebuild anything.
+# The build directory is built, configured again and then built with a dry run
+# (make -n, ninja -n). Every object that would be compiled and every target that
+# would be linked is reported, and the check fails if there is any. This covers
+# all outputs of the configure that a build depends on: generated files,
+# configure_file() and file(GENERATE) results and the compile and link flags.
+#
+# As a diagnostic, the files written with cmpWriteGeneratedFile and
+# cmpAppendGeneratedFile (CMP_GeneratedFiles.txt of the build directory) and the
+# headers in CMP_CHECK_HEADER_DIR that were written again with the same contents
+# are listed as well. They explain most rebuilds but are not checked on their own.
+#
+# Only the Makefile and Ninja generators have a dry run.
+#
+# Usage:
+#   cmake -DCMP_CHECK_SOURCE_DIR=<source dir> -DCMP_CHECK_BINARY_DIR=<build dir>
+#         [-DCMP_CHECK_HEADER_DIR=<build dir>/cmp] [-DCMP_CHECK_CONFIG=<config>]
+#         -P cmpCheckReconfigure.cmake
+#-------------------------------------------------------------------------------
+cmake_minimum_required(VERSION 3.12)
+
+foreach(name SOURCE_DIR BINARY_DIR)
+  if("${CMP_CHECK_${name}}" STREQUAL "")
+    message(FATAL_ERROR "cmpCheckReconfigure: CMP_CHECK_${name} is not set")
+  endif()
+endforeach()
+
+file(STRINGS "${CMP_CHECK_BINARY_DIR}/CMakeCache.txt" generator REGEX "^CMAKE_GENERATOR:INTERNAL=")
+string(REGEX REPLACE "^CMAKE_GENERATOR:INTERNAL=" "" generator "${generator}")
+if(generator MATCHES "Ninja")
+  set(dryRunArgs -n -d explain)
+elseif(generator MATCHES "Makefiles")
+  set(dryRunArgs -n)
+else()
+  message(FATAL_ERROR "cmpCheckReconfigure: The ${generator} generator has no dry run, use a Makefile or Ninja generator")
+endif()
+set(config "")
+if(NOT "${CMP_CHECK_CONFIG}" STREQUAL "")
+  set(config --config ${CMP_CHECK_CONFIG})
+endif()
+
+#-------------------------------------------------------------------------------
+# Bring the build up to date, so only the configure can make it out of date
+message(STATUS "cmpCheckReconfigure: Building ${CMP_CHECK_BINARY_DIR}")
+execute_process(COMMAND ${CMAKE_COMMAND} --build "${CMP_CHECK_BINARY_DIR}" ${config}
+                RESULT_VARIABLE result OUTPUT_QUIET)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "cmpCheckReconfigure: Building ${CMP_CHECK_BINARY_DIR} failed")
+endif()
+
+# Time stamps and hashes of the generated files before configuring again
+set(files "")
+if(EXISTS "${CMP_CHECK_BINARY_DIR}/CMP_GeneratedFiles.txt")
+  file(STRINGS "${CMP_CHECK_BINARY_DIR}/CMP_GeneratedFiles.txt" files)
+endif()
+if(NOT "${CMP_CHECK_HEADER_DIR}" STREQUAL "" AND IS_DIRECTORY "${CMP_CHECK_HEADER_DIR}")
+  file(GLOB headers LIST_DIRECTORIES false "${CMP_CHECK_HEADER_DIR}/*")
+  list(APPEND files ${headers})
+endif()
+set(checked "")
+foreach(file ${files})
+  if(EXISTS "${file}")
+    list(APPEND checked "${file}")
+    list(LENGTH checked index)
+    file(TIMESTAMP "${file}" before_${index} "%s")
+    file(SHA256 "${file}" hash_${index})
+  endif()
+endforeach()
+
+# The time stamps have a resolution of one second
+execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1)
+message(STATUS "cmpCheckReconfigure: Configuring ${CMP_CHECK_BINARY_DIR} again")
+execute_process(COMMAND ${CMAKE_COMMAND} -S "${CMP_CHECK_SOURCE_DIR}" -B "${CMP_CHECK_BINARY_DIR}"
+                RESULT_VARIABLE result OUTPUT_QUIET)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "cmpCheckReconfigure: Configuring ${CMP_CHECK_BINARY_DIR} again failed")
+endif()
+
+#-------------------------------------------------------------------------------
+# What a build would do now
+execute_process(COMMAND ${CMAKE_COMMAND} --build "${CMP_CHECK_BINARY_DIR}" ${config} -- ${dryRunArgs}
+                RESULT_VARIABLE result OUTPUT_VARIABLE dryRun ERROR_VARIABLE explain)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "cmpCheckReconfigure: The dry run of the build failed:\n${explain}")
+endif()
+string(REPLACE ";" "\\;" dryRun "${dryRun}")
+string(REPLACE "\n" ";" dryRun "${dryRun}")
+set(objects "")
+set(targets "")
+foreach(line ${dryRun})
+  if(line MATCHES "Building [A-Za-z]+ object ([^\"]+)")
+    string(STRIP "${CMAKE_MATCH_1}" object)
+    list(APPEND objects "${object}")
+  elseif(line MATCHES "Linking [A-Za-z]+ (executable|shared library|static library|shared module|module) ([^\"]+)")
+    string(STRIP "${CMAKE_MATCH_2}" target)
+    list(APPEND targets "${target}")
+  endif()
+endforeach()
+list(REMOVE_DUPLICATES objects)
+list(REMOVE_DUPLICATES targets)
+
+# Diagnostic: unchanged files that were written again
+set(index 0)
+foreach(file ${checked})
+  math(EXPR index "${index} + 1")
+  if(NOT EXISTS "${file}")
+    continue()
+  endif()
+  file(TIMESTAMP "${file}" after "%s")
+  file(SHA256 "${file}" hash)
+  if(NOT "${after}" STREQUAL "${before_${index}}" AND "${hash}" STREQUAL "${hash_${index}}")
+    message(STATUS "  ${file} was written again with the same contents")
+  endif()
+endforeach()
+
+list(LENGTH objects numObjects)
+list(LENGTH targets numTargets)
+if(numObjects GREATER 0 OR numTargets GREATER 0)
+  foreach(target ${targets})
+    message(STATUS "  Would link ${target}")
+  endforeach()
+  foreach(object ${objects})
+    message(STATUS "  Would compile ${object}")
+  endforeach()
+  if(generator MATCHES "Ninja" AND NOT "${explain}" STREQUAL "")
+    message(STATUS "ninja -d explain:\n${explain}")
+  endif()
+  message(FATAL_ERROR "cmpCheckReconfigure: Configuring again would relink ${numTargets} targets and recompile ${numObjects} objects")
+endif()
+message(STATUS "cmpCheckReconfigure: Configuring again leaves the build up to date")
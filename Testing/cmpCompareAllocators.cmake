@@ -0,0 +1,137 @@
+#-------------------------------------------------------------------------------
+# Compares the benchmarks of the SCALABLE_ALLOCATOR unit tests under glibc's
+# malloc and under TBB's scalable allocator. Every test executable is run with
+# LD_PRELOAD unset and with the tbbmalloc proxy in LD_PRELOAD, alternately, so a
+# change of the machine load hits both alike. The median of the run medians of
+# every benchmark is reported for both allocators.
+#
+# Every benchmark reports the library that malloc() resolved to ("allocator" of
+# its results line). A run that did not use the allocator it was started for,
+# e.g. because the proxy is also linked into the test, is reported and not
+# counted.
+#
+# Usage:
+#   cmake -DCMP_ALLOCATOR_EXECUTABLES=<test executable>[|<test executable>...]
+#         -DCMP_ALLOCATOR_PRELOAD=<path to libtbbmalloc_proxy.so>
+#         [-DCMP_ALLOCATOR_RUNS=3] [-DCMP_ALLOCATOR_BENCH_ARGS=--bench-stable]
+#         [-DCMP_ALLOCATOR_DIR=<scratch dir>]
+#         -P cmpCompareAllocators.cmake
+# Unset variables are also read from the environment, which is how the
+# ALLOCATOR_COMPARE target of the build directory gets them:
+#   CMP_ALLOCATOR_RUNS=5 CMP_ALLOCATOR_BENCH_ARGS=--bench-stable make ALLOCATOR_COMPARE
+#-------------------------------------------------------------------------------
+cmake_minimum_required(VERSION 3.12)
+
+include(${CMAKE_CURRENT_LIST_DIR}/cmpBenchmarkUtilities.cmake)
+
+foreach(name EXECUTABLES PRELOAD RUNS BENCH_ARGS DIR)
+  if("${CMP_ALLOCATOR_${name}}" STREQUAL "" AND NOT "$ENV{CMP_ALLOCATOR_${name}}" STREQUAL "")
+    set(CMP_ALLOCATOR_${name} "$ENV{CMP_ALLOCATOR_${name}}")
+  endif()
+endforeach()
+foreach(name EXECUTABLES PRELOAD)
+  if("${CMP_ALLOCATOR_${name}}" STREQUAL "")
+    message(FATAL_ERROR "cmpCompareAllocators: CMP_ALLOCATOR_${name} is not set")
+  endif()
+endforeach()
+if(NOT EXISTS "${CMP_ALLOCATOR_PRELOAD}")
+  message(FATAL_ERROR "cmpCompareAllocators: The tbbmalloc proxy ${CMP_ALLOCATOR_PRELOAD} does not exist")
+endif()
+if("${CMP_ALLOCATOR_RUNS}" STREQUAL "")
+  set(CMP_ALLOCATOR_RUNS 3)
+endif()
+if("${CMP_ALLOCATOR_DIR}" STREQUAL "")
+  set(CMP_ALLOCATOR_DIR "${CMAKE_CURRENT_BINARY_DIR}/AllocatorCompare")
+endif()
+file(MAKE_DIRECTORY "${CMP_ALLOCATOR_DIR}")
+string(REPLACE "|" ";" executables "${CMP_ALLOCATOR_EXECUTABLES}")
+separate_arguments(benchArgs UNIX_COMMAND "${CMP_ALLOCATOR_BENCH_ARGS}")
+
+# <test>/<benchmark> of every reported benchmark. The medians of the runs are
+# kept in system_<index> and scalable_<index>.
+set(benchmarks "")
+set(resultsFile "${CMP_ALLOCATOR_DIR}/results.json")
+foreach(executable ${executables})
+  get_filename_component(test "${executable}" NAME_WE)
+  message(STATUS "cmpCompareAllocators: Running ${test} ${CMP_ALLOCATOR_RUNS} times with each allocator")
+  foreach(run RANGE 1 ${CMP_ALLOCATOR_RUNS})
+    # Alternate which allocator goes first
+    math(EXPR odd "${run} % 2")
+    if(odd)
+      set(allocators system scalable)
+    else()
+      set(allocators scalable system)
+    endif()
+    foreach(allocator ${allocators})
+      if(allocator STREQUAL "scalable")
+        set(environment "LD_PRELOAD=${CMP_ALLOCATOR_PRELOAD}")
+      else()
+        set(environment "--unset=LD_PRELOAD")
+      endif()
+      file(REMOVE "${resultsFile}")
+      execute_process(COMMAND ${CMAKE_COMMAND} -E env ${environment} "${executable}" "--bench-results=${resultsFile}" ${benchArgs}
+                      RESULT_VARIABLE result OUTPUT_QUIET ERROR_QUIET)
+      if(NOT result EQUAL 0)
+        message(STATUS "  ${test} failed with the ${allocator} allocator (${result}), its benchmarks are still compared")
+      endif()
+      if(NOT EXISTS "${resultsFile}")
+        continue()
+      endif()
+      file(STRINGS "${resultsFile}" lines)
+      foreach(line ${lines})
+        if(NOT line MATCHES "\"benchmark\":\"([^\"]*)\"")
+          continue()
+        endif()
+        set(benchmark "${test}/${CMAKE_MATCH_1}")
+        set(used "")
+        if(line MATCHES "\"allocator\":\"([^\"]*)\"")
+          set(used "${CMAKE_MATCH_1}")
+        endif()
+        string(FIND "${used}" "tbbmalloc" found)
+        if(allocator STREQUAL "scalable" AND found EQUAL -1 OR allocator STREQUAL "system" AND NOT found EQUAL -1)
+          message(STATUS "  ${benchmark}: the ${allocator} run used malloc() of '${used}', not counted")
+          continue()
+        endif()
+        if(line MATCHES "\"median_s\":([0-9.eE+-]+)")
+          _cmpSecondsToNs("${CMAKE_MATCH_1}" ns)
+          list(FIND benchmarks "${benchmark}" index)
+          if(index EQUAL -1)
+            list(LENGTH benchmarks index)
+            list(APPEND benchmarks "${benchmark}")
+          endif()
+          list(APPEND ${allocator}_${index} ${ns})
+        endif()
+      endforeach()
+    endforeach()
+  endforeach()
+endforeach()
+
+#-------------------------------------------------------------------------------
+# Report
+message(STATUS "")
+message(STATUS "cmpCompareAllocators: Median of ${CMP_ALLOCATOR_RUNS} runs, glibc malloc / tbbmalloc (${CMP_ALLOCATOR_PRELOAD})")
+set(index 0)
+foreach(benchmark ${benchmarks})
+  _cmpMedianNs("${system_${index}}" system)
+  _cmpMedianNs("${scalable_${index}}" scalable)
+  _cmpFormatNs("${system}" systemFormatted)
+  _cmpFormatNs("${scalable}" scalableFormatted)
+  set(change "")
+  if(NOT "${system}" STREQUAL "" AND NOT "${scalable}" STREQUAL "" AND system GREATER 0)
+    # Change of the run time in tenths of a percent
+    math(EXPR permille "(${scalable} - ${system}) * 1000 / ${system}")
+    set(sign "+")
+    if(permille LESS 0)
+      set(sign "-")
+      math(EXPR permille "0 - ${permille}")
+    endif()
+    math(EXPR whole "${permille} / 10")
+    math(EXPR tenth "${permille} % 10")
+    set(change ", ${sign}${whole}.${tenth}% with tbbmalloc")
+  endif()
+  message(STATUS "  ${benchmark}: ${systemFormatted} / ${scalableFormatted}${change}")
+  math(EXPR index "${index} + 1")
+endforeach()
+if("${benchmarks}" STREQUAL "")
+  message(STATUS "  No benchmark results. The tests have to register benchmarks, e.g. with DREAM3D_REGISTER_BENCHMARK")
+endif()
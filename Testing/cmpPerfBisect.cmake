@@ -0,0 +1,349 @@
+#-------------------------------------------------------------------------------
+# Finds the commit that made a benchmark slower. The good and the bad revision
+# are measured first; the bad one has to be slower than the good one by more
+# than the threshold. "git bisect run" then builds every step incrementally in a
+# scratch build directory and calls a step slower than the threshold bad. The
+# sources are checked out into a separate git worktree, so the checkout the
+# script is started from is not touched.
+#
+# Every build is configured again so the version header of cmpGitRevisionString
+# names the revision that was built. A step whose version header names another
+# revision is reported. A step that does not configure, build or report the
+# benchmark is skipped.
+#
+# Usage:
+#   cmake -DCMP_BISECT_SOURCE_DIR=<source dir> -DCMP_BISECT_TEST=<test target>
+#         -DCMP_BISECT_BENCHMARK=<benchmark> -DCMP_BISECT_GOOD=<revision>
+#         [-DCMP_BISECT_BAD=HEAD] [-DCMP_BISECT_THRESHOLD=5] [-DCMP_BISECT_RUNS=3]
+#         [-DCMP_BISECT_DIR=<scratch dir>] [-DCMP_BISECT_CMAKE_ARGS=-DCMAKE_BUILD_TYPE=Release]
+#         [-DCMP_BISECT_BENCH_ARGS=--bench-stable] [-DCMP_BISECT_GENERATOR=<generator>]
+#         [-DCMP_BISECT_CONFIG=<config>] [-DCMP_BISECT_SEED_CACHE=<build dir>/CMakeCache.txt]
+#         -P cmpPerfBisect.cmake
+#
+#   CMP_BISECT_TEST       The AddSIMPLUnitTest target that runs the benchmark
+#   CMP_BISECT_BENCHMARK  The name the benchmark is reported under, e.g. "Foo()"
+#                         for DREAM3D_REGISTER_BENCHMARK(Foo(), 10)
+#   CMP_BISECT_THRESHOLD  Slowdown of the median in percent of the good revision
+#                         that counts as a regression; keep it above the noise
+#   CMP_BISECT_RUNS       Runs of the test per step; the median of the run
+#                         medians is compared
+#   CMP_BISECT_SEED_CACHE The cache of an existing build. A new scratch build is
+#                         configured with its settings (paths to Qt, HDF5, ...)
+# Unset variables are also read from the environment, which is how the
+# PERF_BISECT target of the build directory gets them:
+#   CMP_BISECT_TEST=FooTest CMP_BISECT_BENCHMARK="Foo()" CMP_BISECT_GOOD=v6.4 make PERF_BISECT
+#-------------------------------------------------------------------------------
+cmake_minimum_required(VERSION 3.12)
+
+include(${CMAKE_CURRENT_LIST_DIR}/cmpBenchmarkUtilities.cmake)
+
+#-------------------------------------------------------------------------------
+# Checks out, configures and builds the current revision of the worktree and
+# runs the benchmark. Sets <var>_MEDIAN in nanoseconds (empty if that failed),
+# <var>_REVISION and <var>_VERSION.
+function(_cmpBisectMeasure var)
+  set(median "")
+  set(version "")
+  execute_process(COMMAND ${GIT_EXECUTABLE} rev-parse --short HEAD WORKING_DIRECTORY "${worktreeDir}"
+                  OUTPUT_VARIABLE revision OUTPUT_STRIP_TRAILING_WHITESPACE)
+  set(${var}_REVISION "${revision}" PARENT_SCOPE)
+  set(${var}_MEDIAN "" PARENT_SCOPE)
+  set(${var}_VERSION "" PARENT_SCOPE)
+
+  set(generator "")
+  if(NOT EXISTS "${buildDir}/CMakeCache.txt")
+    if(NOT "${CMP_BISECT_GENERATOR}" STREQUAL "")
+      set(generator -G "${CMP_BISECT_GENERATOR}")
+    endif()
+    if(EXISTS "${CMP_BISECT_DIR}/SeedCache.cmake")
+      list(APPEND generator -C "${CMP_BISECT_DIR}/SeedCache.cmake")
+    endif()
+  endif()
+  message(STATUS "[${revision}] Configuring and building ${CMP_BISECT_TEST}")
+  execute_process(COMMAND ${CMAKE_COMMAND} ${generator} ${CMP_BISECT_CMAKE_ARGS} "${worktreeDir}"
+                  WORKING_DIRECTORY "${buildDir}" RESULT_VARIABLE result OUTPUT_QUIET ERROR_VARIABLE errors)
+  if(NOT result EQUAL 0)
+    message(STATUS "[${revision}] Configuring failed:\n${errors}")
+    return()
+  endif()
+  set(config "")
+  if(NOT "${CMP_BISECT_CONFIG}" STREQUAL "")
+    set(config --config ${CMP_BISECT_CONFIG})
+  endif()
+  execute_process(COMMAND ${CMAKE_COMMAND} --build "${buildDir}" --target ${CMP_BISECT_TEST} ${config}
+                  RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+  if(NOT result EQUAL 0)
+    string(LENGTH "${output}" length)
+    if(length GREATER 4000)
+      math(EXPR start "${length} - 4000")
+      string(SUBSTRING "${output}" ${start} -1 output)
+    endif()
+    message(STATUS "[${revision}] Building ${CMP_BISECT_TEST} failed:\n${output}")
+    return()
+  endif()
+
+  # The version that cmpGitRevisionString put into the build, tag.patch.revision
+  file(GLOB_RECURSE versionHeaders "${buildDir}/*Version*.h")
+  foreach(header ${versionHeaders})
+    file(STRINGS "${header}" lines REGEX "_VER_REVISION +\"|_COMPLETE +\"")
+    set(headerRevision "")
+    set(headerVersion "")
+    foreach(line ${lines})
+      if(line MATCHES "_VER_REVISION +\"([^\"]*)\"")
+        set(headerRevision "${CMAKE_MATCH_1}")
+      elseif(line MATCHES "_COMPLETE +\"([^\"]*)\"")
+        set(headerVersion "${CMAKE_MATCH_1}")
+      endif()
+    endforeach()
+    if(NOT "${headerRevision}" STREQUAL "")
+      string(FIND "${revision}" "${headerRevision}" match)
+      if(NOT match EQUAL 0)
+        string(FIND "${headerRevision}" "${revision}" match)
+      endif()
+      # "0" means git describe found no tag, so the header can not name a revision
+      if(match EQUAL 0 OR "${headerRevision}" STREQUAL "0")
+        set(version "${headerVersion}")
+      else()
+        set(version "${headerVersion} (version header names ${headerRevision})")
+      endif()
+      break()
+    endif()
+  endforeach()
+  set(${var}_VERSION "${version}" PARENT_SCOPE)
+
+  # The executable is listed in the manifest AddSIMPLUnitTest writes for the test,
+  # one per configuration; single configuration builds only have the one they build
+  set(manifest "${buildDir}/TestManifests/${CMP_BISECT_TEST}-${CMP_BISECT_CONFIG}.manifest")
+  if("${CMP_BISECT_CONFIG}" STREQUAL "")
+    file(GLOB manifest "${buildDir}/TestManifests/${CMP_BISECT_TEST}-*.manifest")
+    list(SORT manifest)
+    list(LENGTH manifest count)
+    if(count GREATER 1)
+      list(GET manifest 0 manifest)
+    endif()
+  endif()
+  set(executable "")
+  if(EXISTS "${manifest}")
+    file(STRINGS "${manifest}" lines REGEX "^executable=")
+    string(REGEX REPLACE "^executable=" "" executable "${lines}")
+  endif()
+  if("${executable}" STREQUAL "" OR NOT EXISTS "${executable}")
+    message(STATUS "[${revision}] No test executable for ${CMP_BISECT_TEST} in ${buildDir}/TestManifests")
+    return()
+  endif()
+
+  set(medians "")
+  set(resultsFile "${CMP_BISECT_DIR}/results.json")
+  foreach(run RANGE 1 ${CMP_BISECT_RUNS})
+    file(REMOVE "${resultsFile}")
+    execute_process(COMMAND "${executable}" "--bench-results=${resultsFile}" ${CMP_BISECT_BENCH_ARGS}
+                    WORKING_DIRECTORY "${buildDir}" OUTPUT_QUIET ERROR_QUIET)
+    if(EXISTS "${resultsFile}")
+      file(STRINGS "${resultsFile}" lines)
+      foreach(line ${lines})
+        string(FIND "${line}" "\"benchmark\":\"${CMP_BISECT_BENCHMARK}\"" found)
+        if(NOT found EQUAL -1 AND line MATCHES "\"median_s\":([0-9.eE+-]+)")
+          _cmpSecondsToNs("${CMAKE_MATCH_1}" ns)
+          list(APPEND medians ${ns})
+        endif()
+      endforeach()
+    endif()
+  endforeach()
+  list(LENGTH medians count)
+  if(count EQUAL 0)
+    message(STATUS "[${revision}] ${CMP_BISECT_TEST} did not report the benchmark '${CMP_BISECT_BENCHMARK}'")
+    return()
+  endif()
+  _cmpMedianNs("${medians}" median)
+  set(runs "")
+  foreach(value ${medians})
+    _cmpFormatNs(${value} formatted)
+    list(APPEND runs "${formatted}")
+  endforeach()
+  string(REPLACE ";" ", " runs "${runs}")
+  _cmpFormatNs(${median} formatted)
+  message(STATUS "[${revision}] ${CMP_BISECT_BENCHMARK}: median ${formatted} (runs ${runs})")
+  set(${var}_MEDIAN "${median}" PARENT_SCOPE)
+endfunction()
+
+#-------------------------------------------------------------------------------
+# One step of "git bisect run": reads the state the driver below wrote and
+# writes the exit code for git bisect (0 good, 1 bad, 125 skip) to a file.
+if(NOT "${CMP_BISECT_STATE}" STREQUAL "")
+  include("${CMP_BISECT_STATE}")
+  _cmpBisectMeasure(step)
+  set(verdict 125)
+  if(NOT "${step_MEDIAN}" STREQUAL "")
+    set(verdict 0)
+    if(step_MEDIAN GREATER CMP_BISECT_LIMIT)
+      set(verdict 1)
+    endif()
+  endif()
+  if(verdict EQUAL 0)
+    set(verdictName good)
+  elseif(verdict EQUAL 1)
+    set(verdictName bad)
+  else()
+    set(verdictName skip)
+  endif()
+  file(APPEND "${CMP_BISECT_DIR}/steps.txt" "${step_REVISION}|${step_VERSION}|${step_MEDIAN}|${verdictName}\n")
+  file(WRITE "${CMP_BISECT_DIR}/verdict" "${verdict}")
+  return()
+endif()
+
+#-------------------------------------------------------------------------------
+# The driver
+foreach(name SOURCE_DIR TEST BENCHMARK GOOD BAD THRESHOLD RUNS DIR CMAKE_ARGS BENCH_ARGS GENERATOR CONFIG SEED_CACHE)
+  if("${CMP_BISECT_${name}}" STREQUAL "" AND NOT "$ENV{CMP_BISECT_${name}}" STREQUAL "")
+    set(CMP_BISECT_${name} "$ENV{CMP_BISECT_${name}}")
+  endif()
+endforeach()
+foreach(name SOURCE_DIR TEST BENCHMARK GOOD)
+  if("${CMP_BISECT_${name}}" STREQUAL "")
+    message(FATAL_ERROR "cmpPerfBisect: CMP_BISECT_${name} is not set")
+  endif()
+endforeach()
+if("${CMP_BISECT_BAD}" STREQUAL "")
+  set(CMP_BISECT_BAD HEAD)
+endif()
+if("${CMP_BISECT_THRESHOLD}" STREQUAL "")
+  set(CMP_BISECT_THRESHOLD 5)
+endif()
+if("${CMP_BISECT_RUNS}" STREQUAL "")
+  set(CMP_BISECT_RUNS 3)
+endif()
+if("${CMP_BISECT_DIR}" STREQUAL "")
+  set(CMP_BISECT_DIR "${CMAKE_CURRENT_BINARY_DIR}/PerfBisect")
+endif()
+if("${CMP_BISECT_CMAKE_ARGS}" STREQUAL "" AND "${CMP_BISECT_SEED_CACHE}" STREQUAL "")
+  set(CMP_BISECT_CMAKE_ARGS -DCMAKE_BUILD_TYPE=Release)
+endif()
+get_filename_component(CMP_BISECT_DIR "${CMP_BISECT_DIR}" ABSOLUTE)
+set(worktreeDir "${CMP_BISECT_DIR}/Source")
+set(buildDir "${CMP_BISECT_DIR}/Build")
+file(MAKE_DIRECTORY "${buildDir}")
+
+# The user settings of the seed cache, without the entries that belong to its build directory
+if(EXISTS "${CMP_BISECT_SEED_CACHE}" AND NOT EXISTS "${buildDir}/CMakeCache.txt")
+  file(STRINGS "${CMP_BISECT_SEED_CACHE}" entries REGEX "^[A-Za-z_][A-Za-z0-9_.+-]*:[A-Z]+=")
+  set(seed "")
+  foreach(entry ${entries})
+    if(entry MATCHES "^([^:]+):([A-Z]+)=(.*)$")
+      set(key "${CMAKE_MATCH_1}")
+      set(type "${CMAKE_MATCH_2}")
+      set(value "${CMAKE_MATCH_3}")
+      if(type STREQUAL "INTERNAL" OR type STREQUAL "STATIC" OR key MATCHES "_(BINARY|SOURCE)_DIR$|^CMAKE_(CACHEFILE_DIR|HOME_DIRECTORY)$|^CMP_BISECT_|^CMP_TEST_REPORT_DIR$")
+        continue()
+      endif()
+      string(APPEND seed "set(${key} [==[${value}]==] CACHE ${type} \"\")\n")
+    endif()
+  endforeach()
+  file(WRITE "${CMP_BISECT_DIR}/SeedCache.cmake" "${seed}")
+endif()
+
+find_package(Git REQUIRED)
+execute_process(COMMAND ${GIT_EXECUTABLE} rev-parse --show-toplevel WORKING_DIRECTORY "${CMP_BISECT_SOURCE_DIR}"
+                OUTPUT_VARIABLE gitRoot OUTPUT_STRIP_TRAILING_WHITESPACE RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "cmpPerfBisect: ${CMP_BISECT_SOURCE_DIR} is not inside of a git repository")
+endif()
+foreach(name GOOD BAD)
+  execute_process(COMMAND ${GIT_EXECUTABLE} rev-parse --verify "${CMP_BISECT_${name}}^{commit}" WORKING_DIRECTORY "${gitRoot}"
+                  OUTPUT_VARIABLE ${name}_SHA OUTPUT_STRIP_TRAILING_WHITESPACE RESULT_VARIABLE result ERROR_QUIET)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "cmpPerfBisect: '${CMP_BISECT_${name}}' is not a revision of ${gitRoot}")
+  endif()
+endforeach()
+file(RELATIVE_PATH sourceSubDir "${gitRoot}" "${CMP_BISECT_SOURCE_DIR}")
+set(gitWorktree "${worktreeDir}")
+set(worktreeDir "${worktreeDir}/${sourceSubDir}")
+
+# The worktree is kept between runs so the next bisection builds incrementally
+if(NOT EXISTS "${gitWorktree}/.git")
+  execute_process(COMMAND ${GIT_EXECUTABLE} worktree add --detach "${gitWorktree}" ${BAD_SHA}
+                  WORKING_DIRECTORY "${gitRoot}" RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "cmpPerfBisect: Could not create the worktree ${gitWorktree}")
+  endif()
+endif()
+execute_process(COMMAND ${GIT_EXECUTABLE} bisect reset WORKING_DIRECTORY "${gitWorktree}" OUTPUT_QUIET ERROR_QUIET)
+
+function(_cmpBisectCheckout sha)
+  execute_process(COMMAND ${GIT_EXECUTABLE} checkout --quiet --detach ${sha} WORKING_DIRECTORY "${gitWorktree}" RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "cmpPerfBisect: Could not check out ${sha} in ${gitWorktree}")
+  endif()
+endfunction()
+
+file(WRITE "${CMP_BISECT_DIR}/steps.txt" "")
+_cmpBisectCheckout(${GOOD_SHA})
+_cmpBisectMeasure(good)
+_cmpBisectCheckout(${BAD_SHA})
+_cmpBisectMeasure(bad)
+file(APPEND "${CMP_BISECT_DIR}/steps.txt" "${good_REVISION}|${good_VERSION}|${good_MEDIAN}|good (given)\n")
+file(APPEND "${CMP_BISECT_DIR}/steps.txt" "${bad_REVISION}|${bad_VERSION}|${bad_MEDIAN}|bad (given)\n")
+if("${good_MEDIAN}" STREQUAL "" OR "${bad_MEDIAN}" STREQUAL "")
+  message(FATAL_ERROR "cmpPerfBisect: The benchmark could not be measured at the good and the bad revision")
+endif()
+
+math(EXPR CMP_BISECT_LIMIT "${good_MEDIAN} + ${good_MEDIAN} * ${CMP_BISECT_THRESHOLD} / 100")
+_cmpFormatNs(${good_MEDIAN} goodFormatted)
+_cmpFormatNs(${bad_MEDIAN} badFormatted)
+_cmpFormatNs(${CMP_BISECT_LIMIT} limitFormatted)
+if(NOT bad_MEDIAN GREATER CMP_BISECT_LIMIT)
+  message(STATUS "cmpPerfBisect: ${CMP_BISECT_BENCHMARK} takes ${badFormatted} at ${CMP_BISECT_BAD} and ${goodFormatted} at ${CMP_BISECT_GOOD}, "
+                 "which is not more than ${CMP_BISECT_THRESHOLD}% slower. Nothing to bisect.")
+  return()
+endif()
+message(STATUS "cmpPerfBisect: ${goodFormatted} at ${CMP_BISECT_GOOD}, ${badFormatted} at ${CMP_BISECT_BAD}; steps slower than ${limitFormatted} are bad")
+
+# The steps run in separate cmake processes that read their settings from here
+set(stateFile "${CMP_BISECT_DIR}/state.cmake")
+file(WRITE "${stateFile}" "")
+foreach(name CMP_BISECT_DIR CMP_BISECT_TEST CMP_BISECT_BENCHMARK CMP_BISECT_RUNS CMP_BISECT_CMAKE_ARGS CMP_BISECT_BENCH_ARGS
+             CMP_BISECT_GENERATOR CMP_BISECT_CONFIG CMP_BISECT_LIMIT GIT_EXECUTABLE worktreeDir buildDir)
+  file(APPEND "${stateFile}" "set(${name} [==[${${name}}]==])\n")
+endforeach()
+
+execute_process(COMMAND ${GIT_EXECUTABLE} bisect start ${BAD_SHA} ${GOOD_SHA} WORKING_DIRECTORY "${gitWorktree}" OUTPUT_QUIET RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "cmpPerfBisect: git bisect start failed")
+endif()
+# cmake -P can not pick its exit code, so the step writes it into a file
+set(verdictFile "${CMP_BISECT_DIR}/verdict")
+execute_process(COMMAND ${GIT_EXECUTABLE} bisect run sh -c "echo 125 > \"$3\"; \"$0\" \"-DCMP_BISECT_STATE=$1\" -P \"$2\"; exit `cat \"$3\"`"
+                        "${CMAKE_COMMAND}" "${stateFile}" "${CMAKE_CURRENT_LIST_FILE}" "${verdictFile}"
+                WORKING_DIRECTORY "${gitWorktree}" OUTPUT_VARIABLE bisectOutput ERROR_VARIABLE bisectOutput)
+execute_process(COMMAND ${GIT_EXECUTABLE} rev-parse --verify --quiet refs/bisect/bad WORKING_DIRECTORY "${gitWorktree}"
+                OUTPUT_VARIABLE firstBad OUTPUT_STRIP_TRAILING_WHITESPACE)
+set(firstBadFound FALSE)
+if(bisectOutput MATCHES "is the first bad commit")
+  set(firstBadFound TRUE)
+  execute_process(COMMAND ${GIT_EXECUTABLE} log -1 "--format=%h %an: %s" ${firstBad} WORKING_DIRECTORY "${gitWorktree}"
+                  OUTPUT_VARIABLE firstBadSummary OUTPUT_STRIP_TRAILING_WHITESPACE)
+endif()
+execute_process(COMMAND ${GIT_EXECUTABLE} bisect reset WORKING_DIRECTORY "${gitWorktree}" OUTPUT_QUIET ERROR_QUIET)
+
+#-------------------------------------------------------------------------------
+# Report
+message(STATUS "")
+message(STATUS "cmpPerfBisect: ${CMP_BISECT_BENCHMARK} of ${CMP_BISECT_TEST}, threshold ${CMP_BISECT_THRESHOLD}% (${limitFormatted})")
+file(STRINGS "${CMP_BISECT_DIR}/steps.txt" steps)
+foreach(step ${steps})
+  string(REPLACE "|" ";" fields "${step}")
+  list(GET fields 0 revision)
+  list(GET fields 1 version)
+  list(GET fields 2 median)
+  list(GET fields 3 verdict)
+  _cmpFormatNs("${median}" formatted)
+  if(NOT "${version}" STREQUAL "")
+    set(version " [${version}]")
+  endif()
+  message(STATUS "  ${revision}${version}: ${formatted} ${verdict}")
+endforeach()
+if(firstBadFound)
+  message(STATUS "First commit slower than the threshold: ${firstBadSummary}")
+else()
+  # Skipped steps leave a range of candidates, git names them
+  message(STATUS "git bisect could not name a single commit:\n${bisectOutput}")
+endif()
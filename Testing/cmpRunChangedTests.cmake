@@ -0,0 +1,205 @@
+#-------------------------------------------------------------------------------
+# Runs the unit tests added with AddSIMPLUnitTest whose inputs changed since
+# their last passing run and reuses the result of all others. The inputs of a
+# test are listed in its manifest (see cmpWriteTestManifest): the executable,
+# the shared libraries it links, its DATA files and the sources of the test and
+# of the targets it links. A test is only skipped if the SHA256 of all of them
+# matches the one recorded when it last passed.
+#
+# Tests whose sources, or the sources of the targets they link, show up in the
+# current diff are never reused and run first so that a broken plugin fails
+# within the first minutes.
+#
+# Plugins and other libraries a test loads at run time, e.g. with QPluginLoader,
+# are not in its manifest. A test that depends on them has to list them as DATA
+# of AddSIMPLUnitTest, otherwise it is reused after they changed.
+# The tests themselves are run by ctest, so timeouts, environment and the other
+# test properties behave exactly as with a plain ctest run.
+#
+# Usage:
+#   cmake -DCMP_TEST_BINARY_DIR=<build dir> [-DCMP_TEST_SOURCE_DIR=<source dir>]
+#         [-DCMP_TEST_CONFIG=<config>] [-DCMP_TEST_DIFF_BASE=<git revision>]
+#         [-DCMP_TEST_ALL=ON] [-DCMP_TEST_CTEST_ARGS=-j8;--output-on-failure]
+#         -P cmpRunChangedTests.cmake
+#
+#   CMP_TEST_DIFF_BASE  Revision the diff is taken against (default HEAD, i.e.
+#                       the uncommitted changes). Untracked files always count.
+#   CMP_TEST_ALL        Ignore the cached results and run everything, affected
+#                       tests still first.
+#-------------------------------------------------------------------------------
+cmake_minimum_required(VERSION 3.12)
+
+if("${CMP_TEST_BINARY_DIR}" STREQUAL "")
+  message(FATAL_ERROR "cmpRunChangedTests: CMP_TEST_BINARY_DIR is not set")
+endif()
+if("${CMP_TEST_DIFF_BASE}" STREQUAL "")
+  set(CMP_TEST_DIFF_BASE HEAD)
+endif()
+set(resultCacheDir "${CMP_TEST_BINARY_DIR}/TestResultCache")
+file(MAKE_DIRECTORY "${resultCacheDir}")
+
+#-------------------------------------------------------------------------------
+# Files changed relative to CMP_TEST_DIFF_BASE, as absolute paths
+set(changedFiles "")
+find_program(GIT_EXECUTABLE git)
+if(GIT_EXECUTABLE AND NOT "${CMP_TEST_SOURCE_DIR}" STREQUAL "")
+  execute_process(COMMAND ${GIT_EXECUTABLE} rev-parse --show-toplevel
+                  WORKING_DIRECTORY "${CMP_TEST_SOURCE_DIR}"
+                  OUTPUT_VARIABLE gitRoot OUTPUT_STRIP_TRAILING_WHITESPACE
+                  RESULT_VARIABLE gitResult ERROR_QUIET)
+  if(gitResult EQUAL 0)
+    execute_process(COMMAND ${GIT_EXECUTABLE} diff --name-only ${CMP_TEST_DIFF_BASE}
+                    WORKING_DIRECTORY "${gitRoot}" OUTPUT_VARIABLE diffFiles ERROR_QUIET)
+    execute_process(COMMAND ${GIT_EXECUTABLE} ls-files --others --exclude-standard
+                    WORKING_DIRECTORY "${gitRoot}" OUTPUT_VARIABLE untrackedFiles ERROR_QUIET)
+    string(REPLACE "\n" ";" diffFiles "${diffFiles};${untrackedFiles}")
+    foreach(file ${diffFiles})
+      list(APPEND changedFiles "${gitRoot}/${file}")
+    endforeach()
+  endif()
+endif()
+
+#-------------------------------------------------------------------------------
+# Hash the inputs of every test and sort the tests into affected, changed and
+# unchanged ones
+if("${CMP_TEST_CONFIG}" STREQUAL "")
+  set(manifestSuffix "-.manifest")
+else()
+  set(manifestSuffix "-${CMP_TEST_CONFIG}.manifest")
+endif()
+file(GLOB manifests "${CMP_TEST_BINARY_DIR}/TestManifests/*${manifestSuffix}")
+
+set(affectedTests "")
+set(changedTests "")
+set(cachedTests "")
+foreach(manifest ${manifests})
+  file(STRINGS "${manifest}" lines)
+  set(name "")
+  set(inputs "")
+  set(sources "")
+  set(directories "")
+  foreach(line ${lines})
+    if(line MATCHES "^name=(.*)$")
+      set(name "${CMAKE_MATCH_1}")
+    elseif(line MATCHES "^(executable|library)=(.*)$")
+      list(APPEND inputs "${CMAKE_MATCH_2}")
+    elseif(line MATCHES "^data=(.*)$")
+      if(IS_DIRECTORY "${CMAKE_MATCH_1}")
+        file(GLOB_RECURSE dataFiles LIST_DIRECTORIES false "${CMAKE_MATCH_1}/*")
+        list(SORT dataFiles)
+        list(APPEND inputs ${dataFiles})
+      else()
+        list(APPEND inputs "${CMAKE_MATCH_1}")
+      endif()
+    elseif(line MATCHES "^source=(.*)$")
+      list(APPEND sources "${CMAKE_MATCH_1}")
+    elseif(line MATCHES "^directory=(.*)$")
+      list(APPEND directories "${CMAKE_MATCH_1}")
+    endif()
+  endforeach()
+
+  # The manifest itself is part of the key, a new data file or library changes it.
+  # The sources cover a change that leaves the executable identical but changes
+  # what the test checks at run time, e.g. a file it reads from the source tree.
+  file(SHA256 "${manifest}" key)
+  foreach(input ${inputs} ${sources})
+    if(EXISTS "${input}" AND NOT IS_DIRECTORY "${input}")
+      file(SHA256 "${input}" inputHash)
+    else()
+      set(inputHash "missing")
+    endif()
+    string(SHA256 key "${key}${input}${inputHash}")
+  endforeach()
+  set(${name}_KEY ${key})
+
+  set(affected FALSE)
+  foreach(file ${changedFiles})
+    list(FIND sources "${file}" index)
+    get_filename_component(fileDir "${file}" DIRECTORY)
+    list(FIND directories "${fileDir}" dirIndex)
+    if(NOT index EQUAL -1 OR NOT dirIndex EQUAL -1)
+      set(affected TRUE)
+      break()
+    endif()
+  endforeach()
+
+  set(cachedKey "")
+  if(EXISTS "${resultCacheDir}/${name}.sha256")
+    file(READ "${resultCacheDir}/${name}.sha256" cachedKey)
+  endif()
+  if(affected)
+    list(APPEND affectedTests ${name})
+  elseif(NOT CMP_TEST_ALL AND "${cachedKey}" STREQUAL "${key}")
+    list(APPEND cachedTests ${name})
+  else()
+    list(APPEND changedTests ${name})
+  endif()
+endforeach()
+
+list(LENGTH manifests numTests)
+list(LENGTH affectedTests numAffected)
+list(LENGTH changedTests numChanged)
+list(LENGTH cachedTests numCached)
+message(STATUS "${numTests} tests: ${numCached} unchanged since their last passing run, ${numAffected} to run affected by the diff against ${CMP_TEST_DIFF_BASE}, ${numChanged} other to run")
+foreach(name ${cachedTests})
+  message(STATUS "  ${name} ... Passed (cached)")
+endforeach()
+
+#-------------------------------------------------------------------------------
+# Runs the given tests through ctest and records the keys of those that passed
+set(failedTests "")
+function(_cmpRunTests)
+  if("${ARGN}" STREQUAL "")
+    return()
+  endif()
+  set(regex "")
+  foreach(name ${ARGN})
+    string(REGEX REPLACE "([.+])" "\\\\\\1" escaped "${name}")
+    if("${regex}" STREQUAL "")
+      set(regex "${escaped}")
+    else()
+      set(regex "${regex}|${escaped}")
+    endif()
+  endforeach()
+  set(config "")
+  if(NOT "${CMP_TEST_CONFIG}" STREQUAL "")
+    set(config -C ${CMP_TEST_CONFIG})
+  endif()
+  set(logFile "${resultCacheDir}/LastRun.log")
+  file(REMOVE "${logFile}")
+  execute_process(COMMAND ${CMAKE_CTEST_COMMAND} ${config} -R "^(${regex})$" -O "${logFile}" ${CMP_TEST_CTEST_ARGS}
+                  WORKING_DIRECTORY "${CMP_TEST_BINARY_DIR}")
+
+  set(passed "")
+  if(EXISTS "${logFile}")
+    file(STRINGS "${logFile}" results REGEX "Test +#[0-9]+: ")
+    foreach(result ${results})
+      if(result MATCHES "Test +#[0-9]+: ([^ ]+) \\.+ +Passed")
+        list(APPEND passed "${CMAKE_MATCH_1}")
+      endif()
+    endforeach()
+  endif()
+  set(failed ${failedTests})
+  foreach(name ${ARGN})
+    list(FIND passed "${name}" index)
+    if(index EQUAL -1)
+      file(REMOVE "${resultCacheDir}/${name}.sha256")
+      list(APPEND failed ${name})
+    else()
+      file(WRITE "${resultCacheDir}/${name}.sha256" "${${name}_KEY}")
+    endif()
+  endforeach()
+  set(failedTests ${failed} PARENT_SCOPE)
+endfunction()
+
+if(numAffected GREATER 0)
+  message(STATUS "Running the tests affected by the diff first")
+endif()
+_cmpRunTests(${affectedTests})
+_cmpRunTests(${changedTests})
+
+if(NOT "${failedTests}" STREQUAL "")
+  string(REPLACE ";" ", " failedTests "${failedTests}")
+  message(FATAL_ERROR "Failed tests: ${failedTests}")
+endif()
+message(STATUS "All tests passed (${numCached} reused from the cache)")
@@ -127,8 +127,10 @@ endmacro()
 #  QT_PLUGINS A List of Qt Plugins that this project needs
 #  OTHER_PLUGINS A list of other plugins that are needed by this Application. These can be those built
 #     by this project or located somewhere else.
+#  SCALABLE_ALLOCATOR Link the tbbmalloc proxy, see cmpScalableAllocator(). On Linux the proxy and
+#     tbbmalloc are deployed with the other dependent libraries.
 function(BuildQtAppBundle)
-    set(options )
+    set(options SCALABLE_ALLOCATOR)
     set(oneValueArgs TARGET DEBUG_EXTENSION ICON_FILE VERSION_MAJOR VERSION_MINOR VERSION_PATCH
                      BINARY_DIR COMPONENT INSTALL_DEST PLUGIN_LIST_FILE)
     set(multiValueArgs SOURCES LINK_LIBRARIES LIB_SEARCH_DIRS QT5_MODULES QT_PLUGINS OTHER_PLUGINS)
@@ -162,10 +164,8 @@ function(BuildQtAppBundle)
         list(APPEND QAB_SOURCES ${qt_menu_nib_sources})
     elseif(WIN32)
         SET(GUI_TYPE WIN32)
-        FILE (WRITE "${CMAKE_CURRENT_BINARY_DIR}/Icon.rc"
-          "// Icon with lowest ID value placed first to ensure application icon\n"
-          "// remains consistent on all systems.\n"
-          "IDI_ICON1 ICON \"${QAB_ICON_FILE}\"")
+        cmpWriteFileIfDifferent(FILE_PATH "${CMAKE_CURRENT_BINARY_DIR}/Icon.rc"
+          CONTENT "// Icon with lowest ID value placed first to ensure application icon\n// remains consistent on all systems.\nIDI_ICON1 ICON \"${QAB_ICON_FILE}\"")
         SET(QAB_ICON_FILE "${CMAKE_CURRENT_BINARY_DIR}/Icon.rc")
         cmp_IDE_GENERATED_PROPERTIES("${TARGET}/Generated/QrcFiles" "${QAB_ICON_FILE}" "")
     endif(APPLE)
@@ -177,11 +177,34 @@ function(BuildQtAppBundle)
       set(QAB_LINK_LIBRARIES ${QAB_LINK_LIBRARIES} Qt5::${qt5module})
     endforeach()
 
+#-- Let "--trace out.json" record the CMP_TRACE_SCOPE trace points of the application
+    if(CMP_ENABLE_TRACING AND NOT "${CMP_TRACE_FILE_NAME}" STREQUAL "")
+        set(CMP_TRACE_MAIN_FILE "${CMAKE_CURRENT_BINARY_DIR}/${QAB_TARGET}_TraceMain.cpp")
+        configure_file(${CMP_CONFIGURED_FILES_SOURCE_DIR}/cmpTraceMain.cpp.in ${CMP_TRACE_MAIN_FILE} @ONLY)
+        cmp_IDE_GENERATED_PROPERTIES("${QAB_TARGET}/Generated" "" "${CMP_TRACE_MAIN_FILE}")
+        list(APPEND QAB_SOURCES ${CMP_TRACE_MAIN_FILE})
+    endif()
+
+#-- Read the libraries of the prefetch list ahead when the installed application starts
+    if(CMP_LINUX_PREFETCH_LIST AND CMAKE_SYSTEM_NAME MATCHES "Linux")
+        set(CMP_PREFETCH_MAIN_FILE "${CMAKE_CURRENT_BINARY_DIR}/${QAB_TARGET}_PrefetchMain.cpp")
+        configure_file(${CMP_CONFIGURED_FILES_SOURCE_DIR}/cmpPrefetchMain.cpp.in ${CMP_PREFETCH_MAIN_FILE} @ONLY)
+        cmp_IDE_GENERATED_PROPERTIES("${QAB_TARGET}/Generated" "" "${CMP_PREFETCH_MAIN_FILE}")
+        list(APPEND QAB_SOURCES ${CMP_PREFETCH_MAIN_FILE})
+    endif()
+
 #-- Add and Link our executable
     add_executable( ${QAB_TARGET} ${GUI_TYPE} ${QAB_SOURCES} )
     target_link_libraries( ${QAB_TARGET}
                             ${QAB_LINK_LIBRARIES}
                              )
+    if(CMP_ENABLE_TRACING AND NOT "${CMP_TRACE_FILE_NAME}" STREQUAL "")
+        target_include_directories(${QAB_TARGET} PRIVATE ${CMP_HEADER_DIR})
+    endif()
+    if(CMP_LINUX_PREFETCH_LIST AND CMAKE_SYSTEM_NAME MATCHES "Linux")
+        find_package(Threads REQUIRED)
+        target_link_libraries(${QAB_TARGET} Threads::Threads)
+    endif()
 
 #-- Make sure we have a proper bundle icon. This must occur AFTER the add_executable command
     if(APPLE)
@@ -200,6 +223,16 @@ function(BuildQtAppBundle)
                 PROPERTIES
                 INSTALL_RPATH \$ORIGIN/../lib
     )
+        # Without the launch script nothing sets LD_LIBRARY_PATH. A DT_RPATH, unlike a
+        # DT_RUNPATH, is also searched for the dependencies of the bundled libraries that
+        # were copied in without an RPATH of their own.
+        if(CMP_LINUX_RPATH_LAUNCH)
+            set_property(TARGET ${QAB_TARGET} APPEND_STRING PROPERTY LINK_FLAGS " -Wl,--disable-new-dtags")
+        endif()
+    endif()
+    cmpFastLinkProfile(TARGET ${QAB_TARGET})
+    if(QAB_SCALABLE_ALLOCATOR)
+        cmpScalableAllocator(TARGET ${QAB_TARGET})
     endif()
 #-- Create install rules for any Qt Plugins that are needed
     set(pi_dest ${QAB_INSTALL_DEST}/Plugins)
@@ -260,6 +293,7 @@ function(BuildQtAppBundle)
         ARCHIVE DESTINATION ${QAB_INSTALL_DEST}
         BUNDLE DESTINATION ${QAB_INSTALL_DEST}
     )
+    cmpSplitDebugInfo(TARGET ${QAB_TARGET} INSTALL_DEST ${QAB_INSTALL_DEST} COMPONENT ${QAB_COMPONENT})
 
 #-- Create last install rule that will run fixup_bundle() on OS X Machines. Other platforms we
 #-- are going to create the install rules elsewhere
@@ -272,8 +306,8 @@ function(BuildQtAppBundle)
         get_property(SIMPLibSearchDirs GLOBAL PROPERTY SIMPLibSearchDirs)
 
 
-        configure_file("${CMP_OSX_TOOLS_SOURCE_DIR}/CompleteBundle.cmake.in"
-                "${OSX_MAKE_STANDALONE_BUNDLE_CMAKE_SCRIPT}" @ONLY IMMEDIATE)
+        cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH "${CMP_OSX_TOOLS_SOURCE_DIR}/CompleteBundle.cmake.in"
+                GENERATED_FILE_PATH "${OSX_MAKE_STANDALONE_BUNDLE_CMAKE_SCRIPT}" AT_ONLY)
 
         install(SCRIPT "${OSX_MAKE_STANDALONE_BUNDLE_CMAKE_SCRIPT}" COMPONENT ${QAB_COMPONENT})
     endif(APPLE)
@@ -293,15 +327,43 @@ function(BuildQtAppBundle)
               "${QAB_BINARY_DIR}/LINUX_Scripts/${QAB_TARGET}_CompleteBundle.cmake")
       set(OPTIMIZE_BUNDLE_SHELL_SCRIPT
               "${QAB_BINARY_DIR}/LINUX_Scripts/${QAB_TARGET}_InstallLibraries.sh")
+      set(split_debug_info OFF)
+      if(CMP_SPLIT_DEBUG_INFO)
+          set(split_debug_info ON)
+      endif()
+      set(scalable_allocator OFF)
+      if(QAB_SCALABLE_ALLOCATOR AND TBB_MALLOC_PROXY_FOUND)
+          set(scalable_allocator ON)
+      endif()
 
-      configure_file("${CMP_LINUX_TOOLS_SOURCE_DIR}/CompleteBundle.cmake.in"
-                    "${LINUX_INSTALL_LIBS_CMAKE_SCRIPT}" @ONLY IMMEDIATE)
+      cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH "${CMP_LINUX_TOOLS_SOURCE_DIR}/CompleteBundle.cmake.in"
+                    GENERATED_FILE_PATH "${LINUX_INSTALL_LIBS_CMAKE_SCRIPT}" AT_ONLY)
       set(PROJECT_INSTALL_DIR ${linux_app_name})
 
-      configure_file("${CMP_LINUX_TOOLS_SOURCE_DIR}/InstallLibraries.sh.in"
-                     "${OPTIMIZE_BUNDLE_SHELL_SCRIPT}" @ONLY IMMEDIATE)
+      cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH "${CMP_LINUX_TOOLS_SOURCE_DIR}/InstallLibraries.sh.in"
+                     GENERATED_FILE_PATH "${OPTIMIZE_BUNDLE_SHELL_SCRIPT}" AT_ONLY)
 
       install(SCRIPT "${LINUX_INSTALL_LIBS_CMAKE_SCRIPT}" COMPONENT ${QAB_COMPONENT})
+
+      # The launch script finds the libraries through LD_LIBRARY_PATH and starts the
+      # application from the installation directory. It is installed next to the
+      # application as <app>.sh. With CMP_LINUX_RPATH_LAUNCH the binary is started
+      # directly, so pipelines with relative paths have to be started from the
+      # installation directory.
+      if(NOT CMP_LINUX_RPATH_LAUNCH)
+        cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH "${CMP_LINUX_TOOLS_SOURCE_DIR}/launch_script.sh.in"
+                      GENERATED_FILE_PATH "${LINUX_MAKE_STANDALONE_LAUNCH_SCRIPT}" AT_ONLY)
+        install(PROGRAMS "${LINUX_MAKE_STANDALONE_LAUNCH_SCRIPT}"
+                DESTINATION ${QAB_INSTALL_DEST}
+                COMPONENT ${QAB_COMPONENT})
+      endif()
+
+      # Runs after the dependent libraries were copied and the debug information was split
+      if(CMP_LINUX_PREFETCH_LIST)
+        install(CODE "execute_process(COMMAND /bin/bash \"${CMP_LINUX_TOOLS_SOURCE_DIR}/RecordPrefetchList.sh\" \"\$ENV{DESTDIR}\${CMAKE_INSTALL_PREFIX}\"
+                                      \"\$ENV{DESTDIR}\${CMAKE_INSTALL_PREFIX}/${QAB_INSTALL_DEST}/$<TARGET_FILE_NAME:${QAB_TARGET}>\" ${CMP_PREFETCH_RECORD_ARGS})"
+                COMPONENT ${QAB_COMPONENT})
+      endif()
     endif()
 
 
@@ -325,13 +387,15 @@ endfunction()
 #  SOURCES   All the source files that are needed to compile the code
 #  LINK_LIBRARIES Dependent libraries that are needed to properly link the executable
 #  LIB_SEARCH_DIRS  A list of directories where certain dependent libraries or plugins can be found
+#  SCALABLE_ALLOCATOR Link the tbbmalloc proxy, see cmpScalableAllocator(). On Linux the proxy and
+#     tbbmalloc are installed into the lib directory next to INSTALL_DEST.
 #
 # Notes: If we were to base a tool off of Qt and NOT just system/3rd party libraries
 #  then we would probably have to get some of the features of the "BuildQtAppBunlde"
 #  back in this function in order to copy in the Qt frameworks, plugins and other
 #  stuff like that. For now none of our 'tools' require Qt.
 function(BuildToolBundle)
-    set(options )
+    set(options SCALABLE_ALLOCATOR)
     set(oneValueArgs TARGET DEBUG_EXTENSION VERSION_MAJOR VERSION_MINOR VERSION_PATCH
                      BINARY_DIR COMPONENT INSTALL_DEST SOLUTION_FOLDER)
     set(multiValueArgs SOURCES LINK_LIBRARIES LIB_SEARCH_DIRS)
@@ -347,10 +411,23 @@ function(BuildToolBundle)
         endif()
     endif()
 
+#-- Let "--metrics out.prom" report the counters, gauges and timers of the tool
+    if(NOT "${CMP_METRICS_FILE_NAME}" STREQUAL "")
+        set(CMP_METRICS_MAIN_FILE "${CMAKE_CURRENT_BINARY_DIR}/${QAB_TARGET}_MetricsMain.cpp")
+        configure_file(${CMP_CONFIGURED_FILES_SOURCE_DIR}/cmpMetricsMain.cpp.in ${CMP_METRICS_MAIN_FILE} @ONLY)
+        cmp_IDE_GENERATED_PROPERTIES("${QAB_TARGET}/Generated" "" "${CMP_METRICS_MAIN_FILE}")
+        list(APPEND QAB_SOURCES ${CMP_METRICS_MAIN_FILE})
+    endif()
+
 #-- Add and Link our executable
     add_executable( ${QAB_TARGET} ${GUI_TYPE} ${QAB_SOURCES} )
     target_link_libraries( ${QAB_TARGET}
                             ${QAB_LINK_LIBRARIES} )
+    if(NOT "${CMP_METRICS_FILE_NAME}" STREQUAL "")
+        find_package(Threads REQUIRED)
+        target_include_directories(${QAB_TARGET} PRIVATE ${CMP_HEADER_DIR})
+        target_link_libraries(${QAB_TARGET} Threads::Threads)
+    endif()
 
 #-- Set the Debug Suffix for the application
     set_target_properties( ${QAB_TARGET}
@@ -363,6 +440,10 @@ function(BuildToolBundle)
             PROPERTIES
             INSTALL_RPATH \$ORIGIN/../lib )
     endif()
+    cmpFastLinkProfile(TARGET ${QAB_TARGET})
+    if(QAB_SCALABLE_ALLOCATOR)
+        cmpScalableAllocator(TARGET ${QAB_TARGET})
+    endif()
     if(NOT "${QAB_SOLUTION_FOLDER}" STREQUAL "")
       set_target_properties(${QAB_TARGET}
                           PROPERTIES FOLDER ${QAB_SOLUTION_FOLDER})
@@ -378,6 +459,28 @@ function(BuildToolBundle)
         BUNDLE DESTINATION ${QAB_INSTALL_DEST}
     )
 
+  #-- Deploy the tbbmalloc proxy the tool links, and tbbmalloc that it loads, into the
+  #-- directory of the INSTALL_RPATH. Tools have no InstallLibraries.sh that would copy them.
+    if(QAB_SCALABLE_ALLOCATOR AND TBB_MALLOC_PROXY_FOUND AND CMAKE_SYSTEM_NAME MATCHES "Linux")
+      set(proxy ${TBB_MALLOC_PROXY_LIBRARY_RELEASE})
+      if(NOT proxy OR CMAKE_BUILD_TYPE MATCHES "Debug" AND TBB_MALLOC_PROXY_LIBRARY_DEBUG)
+          set(proxy ${TBB_MALLOC_PROXY_LIBRARY_DEBUG})
+      endif()
+      get_filename_component(tbb_lib_dir "${proxy}" DIRECTORY)
+      get_filename_component(proxy_name "${proxy}" NAME_WE)
+      string(REPLACE "tbbmalloc_proxy" "tbbmalloc" malloc_name "${proxy_name}")
+      # The libraries and their symbolic links, which the installation keeps as links
+      file(GLOB tbb_malloc_files "${tbb_lib_dir}/${proxy_name}.so*" "${tbb_lib_dir}/${malloc_name}.so*")
+      if(tbb_malloc_files)
+        install(FILES ${tbb_malloc_files}
+                DESTINATION ${QAB_INSTALL_DEST}/../lib
+                COMPONENT ${QAB_COMPONENT})
+      endif()
+      # The proxy loads tbbmalloc without an RPATH of its own. Unlike a DT_RUNPATH, the
+      # DT_RPATH of the tool is also searched for the dependencies of its libraries.
+      set_property(TARGET ${QAB_TARGET} APPEND_STRING PROPERTY LINK_FLAGS " -Wl,--disable-new-dtags")
+    endif()
+
 
 #-- Create last install rule that will run fixup_bundle() on OS X Machines. Other platforms we
 #-- are going to create the install rules elsewhere
@@ -492,10 +595,207 @@ macro(LibraryProperties targetName DEBUG_EXTENSION)
                 INSTALL_RPATH \$ORIGIN/../lib)
     endif()
 
+    # The installed copies are split by the Linux bundle installation script
+    cmpSplitDebugInfo(TARGET ${targetName})
+
    endif( BUILD_SHARED_LIBS)
 
+    cmpFastLinkProfile(TARGET ${targetName})
+
 endmacro(LibraryProperties DEBUG_EXTENSION)
 
+#-------------------------------------------------------------------------------
+# When CMP_SPLIT_DEBUG_INFO is ON (Linux only) the target is compiled with split
+# DWARF and compressed debug sections and is linked with a build-id and, if the
+# linker supports it, a .gdb_index so that loading the symbols stays fast.
+# If INSTALL_DEST is given the installed binary has its debug information moved
+# into CMP_SPLIT_DEBUG_INFO_DIR and is then stripped.
+#  TARGET        The target to set the flags on
+#  INSTALL_DEST  The directory inside of CMAKE_INSTALL_PREFIX the target is installed into
+#  COMPONENT     The install component of the target
+#-------------------------------------------------------------------------------
+function(cmpSplitDebugInfo)
+    set(options)
+    set(oneValueArgs TARGET INSTALL_DEST COMPONENT)
+    cmake_parse_arguments(Z "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
+
+    if(NOT CMP_SPLIT_DEBUG_INFO OR NOT CMAKE_SYSTEM_NAME MATCHES "Linux")
+        return()
+    endif()
+
+    if(NOT DEFINED CMP_COMPILER_HAS_GSPLIT_DWARF)
+        include(CheckCXXCompilerFlag)
+        include(CheckCXXSourceCompiles)
+        check_cxx_compiler_flag(-gsplit-dwarf CMP_COMPILER_HAS_GSPLIT_DWARF)
+        check_cxx_compiler_flag(-gz CMP_COMPILER_HAS_GZ)
+        set(CMAKE_REQUIRED_FLAGS "-Wl,--build-id")
+        check_cxx_source_compiles("int main() { return 0; }" CMP_LINKER_HAS_BUILD_ID)
+        set(CMAKE_REQUIRED_FLAGS "-Wl,--gdb-index")
+        check_cxx_source_compiles("int main() { return 0; }" CMP_LINKER_HAS_GDB_INDEX)
+    endif()
+
+    if(CMP_COMPILER_HAS_GSPLIT_DWARF)
+        target_compile_options(${Z_TARGET} PRIVATE -gsplit-dwarf)
+    endif()
+    # Only the linked binaries get compressed sections. Compressed .dwo files can not
+    # be packed by dwp and the symbol files are compressed when they are split out.
+    if(CMP_COMPILER_HAS_GZ)
+        set_property(TARGET ${Z_TARGET} APPEND_STRING PROPERTY LINK_FLAGS " -gz")
+    endif()
+    if(CMP_LINKER_HAS_BUILD_ID)
+        set_property(TARGET ${Z_TARGET} APPEND_STRING PROPERTY LINK_FLAGS " -Wl,--build-id")
+    endif()
+    if(CMP_LINKER_HAS_GDB_INDEX)
+        set_property(TARGET ${Z_TARGET} APPEND_STRING PROPERTY LINK_FLAGS " -Wl,--gdb-index")
+    endif()
+
+    if(NOT "${Z_INSTALL_DEST}" STREQUAL "")
+        if("${Z_COMPONENT}" STREQUAL "")
+            set(Z_COMPONENT Applications)
+        endif()
+        install(CODE "execute_process(COMMAND /bin/bash \"${CMP_LINUX_TOOLS_SOURCE_DIR}/SplitDebugInfo.sh\" \"${CMP_SPLIT_DEBUG_INFO_DIR}\"
+                                      \"\$ENV{DESTDIR}\${CMAKE_INSTALL_PREFIX}/${Z_INSTALL_DEST}/$<TARGET_FILE_NAME:${Z_TARGET}>\"
+                                      RESULT_VARIABLE splitResult)
+                      if(NOT splitResult EQUAL 0)
+                        message(FATAL_ERROR \"Splitting the debug information of $<TARGET_FILE_NAME:${Z_TARGET}> failed (\${splitResult})\")
+                      endif()"
+                COMPONENT ${Z_COMPONENT})
+    endif()
+endfunction()
+
+#-------------------------------------------------------------------------------
+# When CMP_FAST_LINK_PROFILE is ON (Linux only) the target is set up for quick
+# relinks during development:
+#  - it is linked with mold, lld or gold, whichever is found first, or with the
+#    linker named by CMP_FAST_LINKER
+#  - it is compiled with split DWARF and linked with a .gdb_index, so the linker
+#    does not have to copy the debug information and gdb still starts quickly
+#  - LINK_DEPENDS_NO_SHARED is set, so a change inside a shared library it links
+#    does not relink it. Changed headers still recompile, and so relink, the
+#    sources that include them.
+#  - every link is timed; "make LINK_TIMES" lists the slowest ones
+# Static libraries are not linked, so only the compile flags apply to them.
+#  TARGET        The target to set the flags on
+#-------------------------------------------------------------------------------
+function(cmpFastLinkProfile)
+    set(options)
+    set(oneValueArgs TARGET)
+    cmake_parse_arguments(Z "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
+
+    if(NOT CMP_FAST_LINK_PROFILE OR NOT CMAKE_SYSTEM_NAME MATCHES "Linux")
+        return()
+    endif()
+
+    # The cached result belongs to the CMP_FAST_LINKER it was found for
+    if(NOT DEFINED CMP_FAST_LINK_FLAG OR NOT "${CMP_FAST_LINK_FLAG_LINKER}" STREQUAL "linker=${CMP_FAST_LINKER}")
+        include(CheckCXXCompilerFlag)
+        include(CheckCXXSourceCompiles)
+        set(linkers ${CMP_FAST_LINKER})
+        if("${linkers}" STREQUAL "")
+            set(linkers mold lld gold)
+        endif()
+        set(CMP_FAST_LINK_FLAG "")
+        foreach(linker ${linkers})
+            set(CMAKE_REQUIRED_QUIET ON)
+            set(CMAKE_REQUIRED_FLAGS "-fuse-ld=${linker}")
+            check_cxx_source_compiles("int main() { return 0; }" CMP_LINKER_${linker}_WORKS)
+            if(CMP_LINKER_${linker}_WORKS)
+                set(CMP_FAST_LINK_FLAG "-fuse-ld=${linker}")
+                break()
+            endif()
+        endforeach()
+        if("${CMP_FAST_LINK_FLAG}" STREQUAL "")
+            message(STATUS "CMP_FAST_LINK_PROFILE: None of '${linkers}' works with ${CMAKE_CXX_COMPILER}, keeping the default linker")
+        else()
+            message(STATUS "CMP_FAST_LINK_PROFILE: Linking with ${CMP_FAST_LINK_FLAG}")
+        endif()
+        set(CMP_FAST_LINK_FLAG "${CMP_FAST_LINK_FLAG}" CACHE INTERNAL "")
+        set(CMP_FAST_LINK_FLAG_LINKER "linker=${CMP_FAST_LINKER}" CACHE INTERNAL "")
+
+        check_cxx_compiler_flag(-gsplit-dwarf CMP_COMPILER_HAS_GSPLIT_DWARF)
+        unset(CMP_FAST_LINKER_HAS_GDB_INDEX CACHE)
+        set(CMAKE_REQUIRED_FLAGS "${CMP_FAST_LINK_FLAG} -Wl,--gdb-index")
+        check_cxx_source_compiles("int main() { return 0; }" CMP_FAST_LINKER_HAS_GDB_INDEX)
+    endif()
+
+    if(CMP_COMPILER_HAS_GSPLIT_DWARF)
+        target_compile_options(${Z_TARGET} PRIVATE -gsplit-dwarf)
+    endif()
+
+    get_target_property(targetType ${Z_TARGET} TYPE)
+    if(NOT targetType MATCHES "EXECUTABLE|SHARED_LIBRARY|MODULE_LIBRARY")
+        return()
+    endif()
+    if(NOT "${CMP_FAST_LINK_FLAG}" STREQUAL "")
+        set_property(TARGET ${Z_TARGET} APPEND_STRING PROPERTY LINK_FLAGS " ${CMP_FAST_LINK_FLAG}")
+    endif()
+    if(CMP_FAST_LINKER_HAS_GDB_INDEX)
+        set_property(TARGET ${Z_TARGET} APPEND_STRING PROPERTY LINK_FLAGS " -Wl,--gdb-index")
+    endif()
+    set_target_properties(${Z_TARGET} PROPERTIES
+        LINK_DEPENDS_NO_SHARED ON
+        RULE_LAUNCH_LINK "/bin/bash \"${CMP_LINUX_TOOLS_SOURCE_DIR}/TimeLink.sh\" \"${CMP_LINK_TIMES_FILE}\" ${Z_TARGET}")
+
+    if(NOT TARGET LINK_TIMES)
+        add_custom_target(LINK_TIMES
+            COMMAND /bin/bash ${CMP_LINUX_TOOLS_SOURCE_DIR}/TimeLink.sh --report ${CMP_LINK_TIMES_FILE}
+            USES_TERMINAL
+            VERBATIM
+            COMMENT "Listing the slowest links of the CMP_FAST_LINK_PROFILE")
+    endif()
+endfunction()
+
+#-------------------------------------------------------------------------------
+# Replaces malloc()/free() of the target with TBB's scalable allocator through
+# the tbbmalloc proxy that FindTBB.cmake locates (TBB_MALLOC_PROXY_LIBRARIES).
+# glibc's malloc serializes many threads on a few arenas; tbbmalloc keeps
+# thread local pools. The proxy is linked into the target so it is loaded, and
+# so replaces the allocator, before main() runs. With PRELOAD (Linux only) it is
+# not linked but put into LD_PRELOAD of the test of the same name, so the same
+# executable can also run with glibc's malloc for comparison.
+# The proxy does not support macOS, where the target keeps the system allocator.
+#  TARGET        The target to replace the allocator of
+#  PRELOAD       Preload the proxy into the test TARGET instead of linking it
+#-------------------------------------------------------------------------------
+function(cmpScalableAllocator)
+    set(options PRELOAD)
+    set(oneValueArgs TARGET)
+    cmake_parse_arguments(Z "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
+
+    if(APPLE)
+        message(STATUS "${Z_TARGET}: The tbbmalloc proxy does not support macOS, keeping the system allocator")
+        return()
+    endif()
+    if(NOT TBB_MALLOC_PROXY_FOUND)
+        message(WARNING "${Z_TARGET}: SCALABLE_ALLOCATOR needs the tbbmalloc proxy library, which was not found. Set TBB_INSTALL_DIR")
+        return()
+    endif()
+
+    if(Z_PRELOAD AND CMAKE_SYSTEM_NAME MATCHES "Linux")
+        set(proxy ${TBB_MALLOC_PROXY_LIBRARY_RELEASE})
+        if(NOT proxy OR CMAKE_BUILD_TYPE MATCHES "Debug" AND TBB_MALLOC_PROXY_LIBRARY_DEBUG)
+            set(proxy ${TBB_MALLOC_PROXY_LIBRARY_DEBUG})
+        endif()
+        set_property(TEST ${Z_TARGET} APPEND PROPERTY ENVIRONMENT "LD_PRELOAD=${proxy}")
+        set_property(GLOBAL PROPERTY CMP_SCALABLE_ALLOCATOR_PRELOAD ${proxy})
+        return()
+    endif()
+
+    if(WIN32)
+        # What including tbb/tbbmalloc_proxy.h into one of the sources would do
+        if(CMAKE_SIZEOF_VOID_P EQUAL 8)
+            set_property(TARGET ${Z_TARGET} APPEND_STRING PROPERTY LINK_FLAGS " /INCLUDE:__TBB_malloc_proxy")
+        else()
+            set_property(TARGET ${Z_TARGET} APPEND_STRING PROPERTY LINK_FLAGS " /INCLUDE:___TBB_malloc_proxy")
+        endif()
+        target_link_libraries(${Z_TARGET} ${TBB_MALLOC_PROXY_LIBRARIES})
+    else()
+        # Nothing references a symbol of the proxy, so keep --as-needed from dropping it.
+        # push/pop-state restores whatever the link line had set for the libraries after it
+        target_link_libraries(${Z_TARGET} -Wl,--push-state,--no-as-needed ${TBB_MALLOC_PROXY_LIBRARIES} -Wl,--pop-state)
+    endif()
+endfunction()
+
 # --------------------------------------------------------------------
 macro(StaticLibraryProperties targetName )
     if(WIN32 AND NOT MINGW)
@@ -565,9 +865,9 @@ function(PluginProperties)
         set(Z_BUILD_TYPE ${Z_DEBUG_EXTENSION})
     endif()
     if(NOT MSVC)
-        file(APPEND ${Z_PLUGIN_FILE} "${CMAKE_LIBRARY_OUTPUT_DIRECTORY}/Plugins/lib${Z_OUTPUT_NAME}${Z_BUILD_TYPE}${Z_LIB_SUFFIX};")
+        cmpAppendGeneratedFile(FILE_PATH ${Z_PLUGIN_FILE} CONTENT "${CMAKE_LIBRARY_OUTPUT_DIRECTORY}/Plugins/lib${Z_OUTPUT_NAME}${Z_BUILD_TYPE}${Z_LIB_SUFFIX};")
     else()
-        file(APPEND ${Z_PLUGIN_FILE} "${CMAKE_LIBRARY_OUTPUT_DIRECTORY}/lib${Z_OUTPUT_NAME}${Z_LIB_SUFFIX};")
+        cmpAppendGeneratedFile(FILE_PATH ${Z_PLUGIN_FILE} CONTENT "${CMAKE_LIBRARY_OUTPUT_DIRECTORY}/lib${Z_OUTPUT_NAME}${Z_LIB_SUFFIX};")
     endif()
 
     if(NOT APPLE)
@@ -581,6 +881,8 @@ function(PluginProperties)
                     )
         endforeach()
     endif()
+    cmpSplitDebugInfo(TARGET ${Z_TARGET_NAME} INSTALL_DEST ${Z_INSTALL_DEST} COMPONENT Applications)
+    cmpFastLinkProfile(TARGET ${Z_TARGET_NAME})
 
     # --------------------------------------------------------------------
     # Add in some compiler definitions
@@ -824,17 +1126,23 @@ endfunction()
 # the generation of files that are really the same.
 #
 function(cmpConfigureFileWithMD5Check)
-    set(options)
+    set(options AT_ONLY)
     set(oneValueArgs CONFIGURED_TEMPLATE_PATH GENERATED_FILE_PATH )
     cmake_parse_arguments(GVS "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
 
+    # AT_ONLY is passed on to configure_file() as @ONLY for templates that contain ${} syntax
+    set(GVS_CONFIGURE_ARGS "")
+    if(GVS_AT_ONLY)
+        set(GVS_CONFIGURE_ARGS @ONLY)
+    endif()
+
  #   message(STATUS "   GVS_CONFIGURED_TEMPLATE_PATH: ${GVS_CONFIGURED_TEMPLATE_PATH}")
  #   message(STATUS "   GVS_GENERATED_FILE_PATH: ${GVS_GENERATED_FILE_PATH}")
 
     # Only Generate a file if it is different than what is already there.
     if(EXISTS ${GVS_GENERATED_FILE_PATH} )
         file(MD5 ${GVS_GENERATED_FILE_PATH} VERSION_HDR_MD5)
-        configure_file(${GVS_CONFIGURED_TEMPLATE_PATH}   ${GVS_GENERATED_FILE_PATH}_tmp  )
+        configure_file(${GVS_CONFIGURED_TEMPLATE_PATH}   ${GVS_GENERATED_FILE_PATH}_tmp ${GVS_CONFIGURE_ARGS} )
 
         file(MD5 ${GVS_GENERATED_FILE_PATH}_tmp VERSION_GEN_HDR_MD5)
         #message(STATUS "  File Exists, doing MD5 Comparison")
@@ -844,18 +1152,93 @@ function(cmpConfigureFileWithMD5Check)
             #message(STATUS "   ${VERSION_GEN_HDR_MD5}")
             #message(STATUS "   ${VERSION_HDR_MD5}")
             #message(STATUS "  Files differ: Replacing with newly generated file")
-            configure_file(${GVS_CONFIGURED_TEMPLATE_PATH}  ${GVS_GENERATED_FILE_PATH} )
+            configure_file(${GVS_CONFIGURED_TEMPLATE_PATH}  ${GVS_GENERATED_FILE_PATH} ${GVS_CONFIGURE_ARGS} )
         else()
             #message(STATUS "  NO Difference in Files")
         endif()
         file(REMOVE ${GVS_GENERATED_FILE_PATH}_tmp)
     else()
       # message(STATUS "  File does NOT Exist, Generating one...")
-      configure_file(${GVS_CONFIGURED_TEMPLATE_PATH} ${GVS_GENERATED_FILE_PATH} )
+      configure_file(${GVS_CONFIGURED_TEMPLATE_PATH} ${GVS_GENERATED_FILE_PATH} ${GVS_CONFIGURE_ARGS} )
     endif()
 
 endfunction()
 
+#-------------------------------------------------------------------------------
+# Generates the parallel_for/parallel_reduce/task_group header. It maps onto TBB
+# if TBB_FOUND is set in the top level directory, which the project usually does
+# after including cmpProject.cmake, so the header is written at the end of the
+# configure (immediately with CMake < 3.19).
+#
+function(cmpConfigureParallelHeader GENERATED_FILE_PATH)
+    set(CMP_PARALLEL_USE_TBB "")
+    if(TBB_FOUND)
+        set(CMP_PARALLEL_USE_TBB 1)
+    endif()
+    cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH ${CMP_CONFIGURED_FILES_SOURCE_DIR}/cmpParallel.h.in
+                                 GENERATED_FILE_PATH ${GENERATED_FILE_PATH} )
+endfunction()
+
+#-------------------------------------------------------------------------------
+# Generates a header with the tuned constants of the kernels, see
+# TuningSupport.hpp. PARAMETERS lists <Kernel>.<Parameter> <default> pairs:
+#
+#   cmpConfigureTunedConstants(GENERATED_FILE_PATH ${PROJECT_BINARY_DIR}/MyTunedConstants.h
+#                              PARAMETERS Convolution.BlockSize 32
+#                                         Convolution.GrainSize 1024)
+#
+# gives cmp::tuned::Convolution::BlockSize and GrainSize. A kernel that the TUNE
+# target tuned has CMP_TUNING_DIR/<Kernel>.cmake, which sets the variable
+# CMP_TUNED_<Kernel>_<Parameter>; the default is used for everything else.
+#
+function(cmpConfigureTunedConstants)
+    set(options)
+    set(oneValueArgs GENERATED_FILE_PATH)
+    set(multiValueArgs PARAMETERS)
+    cmake_parse_arguments(Z "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
+
+    list(LENGTH Z_PARAMETERS count)
+    math(EXPR odd "${count} % 2")
+    if(odd)
+        message(FATAL_ERROR "cmpConfigureTunedConstants: PARAMETERS takes <Kernel>.<Parameter> <default> pairs")
+    endif()
+
+    set(CMP_TUNED_CONSTANTS "")
+    set(kernel "")
+    while(Z_PARAMETERS)
+        list(GET Z_PARAMETERS 0 name)
+        list(GET Z_PARAMETERS 1 default)
+        list(REMOVE_AT Z_PARAMETERS 0 1)
+        if(NOT name MATCHES "^([A-Za-z_][A-Za-z0-9_]*)\\.([A-Za-z_][A-Za-z0-9_]*)$")
+            message(FATAL_ERROR "cmpConfigureTunedConstants: '${name}' is not <Kernel>.<Parameter>")
+        endif()
+        set(parameter ${CMAKE_MATCH_2})
+        if(NOT "${CMAKE_MATCH_1}" STREQUAL "${kernel}")
+            if(NOT "${kernel}" STREQUAL "")
+                string(APPEND CMP_TUNED_CONSTANTS "} // namespace ${kernel}\n")
+            endif()
+            set(kernel ${CMAKE_MATCH_1})
+            string(APPEND CMP_TUNED_CONSTANTS "namespace ${kernel}\n{\n")
+            if(EXISTS "${CMP_TUNING_DIR}/${kernel}.cmake")
+                include("${CMP_TUNING_DIR}/${kernel}.cmake")
+                set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${CMP_TUNING_DIR}/${kernel}.cmake")
+            endif()
+        endif()
+        if(DEFINED CMP_TUNED_${kernel}_${parameter})
+            string(APPEND CMP_TUNED_CONSTANTS "constexpr int64_t ${parameter} = ${CMP_TUNED_${kernel}_${parameter}}; // Tuned, default ${default}\n")
+        else()
+            string(APPEND CMP_TUNED_CONSTANTS "constexpr int64_t ${parameter} = ${default}; // Default, not tuned\n")
+        endif()
+    endwhile()
+    if(NOT "${kernel}" STREQUAL "")
+        string(APPEND CMP_TUNED_CONSTANTS "} // namespace ${kernel}\n")
+    endif()
+
+    get_filename_component(CMP_TUNED_HEADER_GUARD ${Z_GENERATED_FILE_PATH} NAME_WE)
+    cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH ${CMP_CONFIGURED_FILES_SOURCE_DIR}/cmpTunedConstants.h.in
+                                 GENERATED_FILE_PATH ${Z_GENERATED_FILE_PATH} )
+endfunction()
+
 #-------------------------------------------------------------------------------
 # This function generates a file ONLY if the MD5 between the "to be" generated file
 # and the current file are different. This will help reduce recompiles based on
@@ -895,6 +1278,82 @@ function(cmpReplaceFileIfDifferent)
 endfunction()
 
 
+#-------------------------------------------------------------------------------
+# This function writes CONTENT into FILE_PATH ONLY if the file does not exist yet
+# or currently holds something different. An unchanged file keeps its time stamp
+# so nothing that depends on it gets rebuilt or reinstalled.
+#
+function(cmpWriteFileIfDifferent)
+    cmake_parse_arguments(PARSE_ARGV 0 Z "" "FILE_PATH;CONTENT" "")
+
+    if(EXISTS "${Z_FILE_PATH}")
+        file(READ "${Z_FILE_PATH}" Z_CURRENT_CONTENT)
+        if("${Z_CURRENT_CONTENT}" STREQUAL "${Z_CONTENT}")
+            return()
+        endif()
+    endif()
+    file(WRITE "${Z_FILE_PATH}" "${Z_CONTENT}")
+endfunction()
+
+#-------------------------------------------------------------------------------
+# These functions build up the contents of a generated file in memory instead of
+# writing to it piece by piece during the configure. The contents are written with
+# cmpWriteFileIfDifferent once the top level CMakeLists.txt file is done, which
+# requires CMake 3.19. Older versions of CMake write the file after every change.
+# While configuring, the current contents can be read with
+#   get_property(content GLOBAL PROPERTY CMP_GENERATED_FILE_CONTENT_<FILE_PATH>)
+#
+#  cmpWriteGeneratedFile(FILE_PATH path CONTENT text)   Replaces the contents
+#  cmpAppendGeneratedFile(FILE_PATH path CONTENT text)  Appends to the contents
+#
+function(cmpWriteGeneratedFile)
+    cmake_parse_arguments(PARSE_ARGV 0 Z "" "FILE_PATH;CONTENT" "")
+    set_property(GLOBAL PROPERTY "CMP_GENERATED_FILE_CONTENT_${Z_FILE_PATH}" "${Z_CONTENT}")
+    _cmpScheduleGeneratedFile("${Z_FILE_PATH}")
+endfunction()
+
+function(cmpAppendGeneratedFile)
+    cmake_parse_arguments(PARSE_ARGV 0 Z "" "FILE_PATH;CONTENT" "")
+    set_property(GLOBAL APPEND_STRING PROPERTY "CMP_GENERATED_FILE_CONTENT_${Z_FILE_PATH}" "${Z_CONTENT}")
+    _cmpScheduleGeneratedFile("${Z_FILE_PATH}")
+endfunction()
+
+function(_cmpScheduleGeneratedFile FILE_PATH)
+    get_property(generatedFiles GLOBAL PROPERTY CMP_GENERATED_FILES)
+    list(FIND generatedFiles "${FILE_PATH}" index)
+    if(index EQUAL -1)
+        set_property(GLOBAL APPEND PROPERTY CMP_GENERATED_FILES "${FILE_PATH}")
+    endif()
+
+    if(CMAKE_VERSION VERSION_LESS 3.19)
+        cmpFlushGeneratedFiles()
+        return()
+    endif()
+
+    get_property(flushScheduled GLOBAL PROPERTY CMP_GENERATED_FILES_FLUSH_SCHEDULED)
+    if(NOT flushScheduled)
+        cmake_language(DEFER DIRECTORY ${CMAKE_SOURCE_DIR} CALL cmpFlushGeneratedFiles)
+        set_property(GLOBAL PROPERTY CMP_GENERATED_FILES_FLUSH_SCHEDULED TRUE)
+    endif()
+endfunction()
+
+#-------------------------------------------------------------------------------
+# Writes every file collected by cmpWriteGeneratedFile/cmpAppendGeneratedFile whose
+# contents changed. Their paths are listed in CMP_GeneratedFiles.txt of the build
+# directory for the CHECK_RECONFIGURE target, see cmpCheckReconfigure.cmake.
+#
+function(cmpFlushGeneratedFiles)
+    get_property(generatedFiles GLOBAL PROPERTY CMP_GENERATED_FILES)
+    set(fileList "")
+    foreach(generatedFile ${generatedFiles})
+        get_property(content GLOBAL PROPERTY "CMP_GENERATED_FILE_CONTENT_${generatedFile}")
+        cmpWriteFileIfDifferent(FILE_PATH "${generatedFile}" CONTENT "${content}")
+        string(APPEND fileList "${generatedFile}\n")
+    endforeach()
+    cmpWriteFileIfDifferent(FILE_PATH "${CMAKE_BINARY_DIR}/CMP_GeneratedFiles.txt" CONTENT "${fileList}")
+endfunction()
+
+
 #-------------------------------------------------------------------------------
 # This function will attempt to generate a build date/time string.
 #
@@ -1192,10 +1651,25 @@ endfunction()
 
 # --------------------------------------------------------------------------
 # Adds a Unit Test 
+#
+# DATA lists the data files and directories the test reads. Together with the
+# test executable, the shared libraries it links and its sources they decide
+# whether the result of the last passing run can be reused, see
+# cmpWriteTestManifest(). Plugins the test loads at run time belong in DATA too.
+#
+# TUNING marks a test that registers tuning runs (DREAM3D_REGISTER_TUNING). The
+# TUNE target runs these with SIMPL_TUNING_DIR set to CMP_TUNING_DIR and then
+# configures the project again, so cmpConfigureTunedConstants() picks up the
+# results.
+#
+# SCALABLE_ALLOCATOR runs the test with the tbbmalloc proxy, preloaded on Linux
+# and linked elsewhere, see cmpScalableAllocator(). On Linux the
+# ALLOCATOR_COMPARE target runs the benchmarks of these tests with glibc's
+# malloc and with tbbmalloc and compares them, see cmpCompareAllocators.cmake.
 function(AddSIMPLUnitTest)
-    set(options)
+    set(options TUNING SCALABLE_ALLOCATOR)
     set(oneValueArgs TESTNAME FOLDER)
-    set(multiValueArgs SOURCES LINK_LIBRARIES INCLUDE_DIRS)
+    set(multiValueArgs SOURCES LINK_LIBRARIES INCLUDE_DIRS DATA)
     cmake_parse_arguments(Z "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
 
     add_executable( ${Z_TESTNAME} ${Z_SOURCES})
@@ -1207,8 +1681,187 @@ function(AddSIMPLUnitTest)
     cmp_IDE_SOURCE_PROPERTIES( "" "" "${Z_SOURCES}" "0")
     target_include_directories(${Z_TESTNAME} PUBLIC ${Z_INCLUDE_DIRS})
     target_link_libraries( ${Z_TESTNAME} ${Z_LINK_LIBRARIES})
+    if(NOT "${CMP_MACHINE_CALIBRATION_FILE}" STREQUAL "")
+        target_compile_definitions(${Z_TESTNAME} PRIVATE SIMPL_MACHINE_CALIBRATION_FILE="${CMP_MACHINE_CALIBRATION_FILE}")
+    endif()
+    if(NOT "${CMP_LATENCY_HISTOGRAM_FILE_NAME}" STREQUAL "")
+        target_include_directories(${Z_TESTNAME} PRIVATE ${CMP_HEADER_DIR})
+        target_compile_definitions(${Z_TESTNAME} PRIVATE SIMPL_LATENCY_HISTOGRAM_HEADER="${CMP_LATENCY_HISTOGRAM_FILE_NAME}")
+    endif()
+    if(NOT "${CMP_TRACE_FILE_NAME}" STREQUAL "")
+        target_include_directories(${Z_TESTNAME} PRIVATE ${CMP_HEADER_DIR})
+        target_compile_definitions(${Z_TESTNAME} PRIVATE SIMPL_TRACE_HEADER="${CMP_TRACE_FILE_NAME}")
+    endif()
+    if(CMP_HAVE_LIBNUMA)
+        target_include_directories(${Z_TESTNAME} PRIVATE ${CMP_LIBNUMA_INCLUDE_DIR})
+        target_link_libraries(${Z_TESTNAME} ${CMP_LIBNUMA_LIBRARY})
+        target_compile_definitions(${Z_TESTNAME} PRIVATE SIMPL_HAVE_LIBNUMA)
+    endif()
+    if(UNIX)
+        # The --profile mode of the tests names the sampled functions with dladdr(),
+        # which only sees the exported symbols of the executable
+        if(CMP_UNIT_TEST_PROFILER)
+            set_target_properties(${Z_TESTNAME} PROPERTIES ENABLE_EXPORTS ON)
+        endif()
+        target_link_libraries(${Z_TESTNAME} ${CMAKE_DL_LIBS})
+    endif()
+    cmpFastLinkProfile(TARGET ${Z_TESTNAME})
     add_test(${Z_TESTNAME} ${CMAKE_RUNTIME_OUTPUT_DIRECTORY}/${Z_TESTNAME})
+    if(NOT "${CMP_TEST_REPORT_DIR}" STREQUAL "")
+        file(MAKE_DIRECTORY "${CMP_TEST_REPORT_DIR}")
+        set_property(TEST ${Z_TESTNAME} APPEND PROPERTY ENVIRONMENT "SIMPL_TEST_REPORT_DIR=${CMP_TEST_REPORT_DIR}")
+    endif()
+
+    # The manifest is written from the top level directory, so resolve relative
+    # DATA entries against the directory of the caller now
+    set(data "")
+    foreach(item ${Z_DATA})
+        get_filename_component(item "${item}" ABSOLUTE BASE_DIR "${CMAKE_CURRENT_SOURCE_DIR}")
+        list(APPEND data "${item}")
+    endforeach()
+    set_property(TARGET ${Z_TESTNAME} PROPERTY CMP_TEST_DATA ${data})
+    set_property(GLOBAL APPEND PROPERTY CMP_UNIT_TESTS ${Z_TESTNAME})
+    if(NOT TARGET RUN_CHANGED_TESTS)
+        add_custom_target(RUN_CHANGED_TESTS
+            COMMAND ${CMAKE_COMMAND} -DCMP_TEST_BINARY_DIR=${CMAKE_BINARY_DIR} -DCMP_TEST_SOURCE_DIR=${CMAKE_SOURCE_DIR}
+                    -DCMP_TEST_CONFIG=$<CONFIG> -P ${CMP_TESTING_SOURCE_DIR}/cmpRunChangedTests.cmake
+            WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+            USES_TERMINAL
+            COMMENT "Running the unit tests whose inputs changed since their last passing run")
+        set_target_properties(RUN_CHANGED_TESTS PROPERTIES FOLDER "Test")
+    endif()
+    # The results are keyed on the test executables, so they have to be current
+    add_dependencies(RUN_CHANGED_TESTS ${Z_TESTNAME})
+    if(NOT TARGET PERF_BISECT)
+        # Settings come from the environment, see cmpPerfBisect.cmake
+        add_custom_target(PERF_BISECT
+            COMMAND ${CMAKE_COMMAND} -DCMP_BISECT_SOURCE_DIR=${CMAKE_SOURCE_DIR} -DCMP_BISECT_SEED_CACHE=${CMAKE_BINARY_DIR}/CMakeCache.txt
+                    -DCMP_BISECT_DIR=${CMAKE_BINARY_DIR}/PerfBisect "-DCMP_BISECT_GENERATOR=${CMAKE_GENERATOR}"
+                    -P ${CMP_TESTING_SOURCE_DIR}/cmpPerfBisect.cmake
+            WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+            USES_TERMINAL
+            COMMENT "Bisecting the benchmark CMP_BISECT_BENCHMARK of CMP_BISECT_TEST between CMP_BISECT_GOOD and CMP_BISECT_BAD")
+        set_target_properties(PERF_BISECT PROPERTIES FOLDER "Test")
+    endif()
+
+    if(Z_SCALABLE_ALLOCATOR)
+        cmpScalableAllocator(TARGET ${Z_TESTNAME} PRELOAD)
+    endif()
+    if(Z_SCALABLE_ALLOCATOR AND TBB_MALLOC_PROXY_FOUND AND CMAKE_SYSTEM_NAME MATCHES "Linux")
+        if(NOT TARGET ALLOCATOR_COMPARE)
+            # The tests are collected in a property, so the ones added later are compared too
+            get_property(preload GLOBAL PROPERTY CMP_SCALABLE_ALLOCATOR_PRELOAD)
+            add_custom_target(ALLOCATOR_COMPARE
+                COMMAND ${CMAKE_COMMAND} "-DCMP_ALLOCATOR_EXECUTABLES=$<JOIN:$<GENEX_EVAL:$<TARGET_PROPERTY:ALLOCATOR_COMPARE,CMP_ALLOCATOR_EXECUTABLES>>,|>"
+                        -DCMP_ALLOCATOR_PRELOAD=${preload} -DCMP_ALLOCATOR_DIR=${CMAKE_BINARY_DIR}/AllocatorCompare
+                        -P ${CMP_TESTING_SOURCE_DIR}/cmpCompareAllocators.cmake
+                WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+                USES_TERMINAL
+                VERBATIM
+                COMMENT "Comparing the benchmarks of the SCALABLE_ALLOCATOR unit tests under glibc malloc and tbbmalloc")
+            set_target_properties(ALLOCATOR_COMPARE PROPERTIES FOLDER "Test")
+        endif()
+        set_property(TARGET ALLOCATOR_COMPARE APPEND PROPERTY CMP_ALLOCATOR_EXECUTABLES $<TARGET_FILE:${Z_TESTNAME}>)
+        add_dependencies(ALLOCATOR_COMPARE ${Z_TESTNAME})
+    endif()
+    if(Z_TUNING)
+        set_property(TEST ${Z_TESTNAME} APPEND PROPERTY LABELS tune)
+        if(NOT TARGET TUNE)
+            file(MAKE_DIRECTORY "${CMP_TUNING_DIR}")
+            add_custom_target(TUNE
+                COMMAND ${CMAKE_COMMAND} -E env SIMPL_TUNING_DIR=${CMP_TUNING_DIR} ${CMAKE_CTEST_COMMAND} -C $<CONFIG> -L tune --output-on-failure
+                COMMAND ${CMAKE_COMMAND} -S${CMAKE_SOURCE_DIR} -B${CMAKE_BINARY_DIR}
+                WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+                USES_TERMINAL
+                COMMENT "Tuning the kernels of the TUNING unit tests into ${CMP_TUNING_DIR}")
+            set_target_properties(TUNE PROPERTIES FOLDER "Test")
+        endif()
+        add_dependencies(TUNE ${Z_TESTNAME})
+    endif()
+
+    # The manifest lists every library the test links, so wait until all targets exist
+    if(CMAKE_VERSION VERSION_LESS 3.19)
+        cmpWriteTestManifest(${Z_TESTNAME})
+    else()
+        # Deferred arguments are expanded when the call runs, so bind the test name now
+        cmake_language(EVAL CODE "cmake_language(DEFER DIRECTORY [[${CMAKE_SOURCE_DIR}]] CALL cmpWriteTestManifest [[${Z_TESTNAME}]])")
+    endif()
+endfunction()
+
+#-------------------------------------------------------------------------------
+# Writes TestManifests/<test>-<config>.manifest into the build directory. It holds
+# one "key=value" line per input of the test executable:
+#   executable=  the test executable
+#   library=     every shared library it links, directly or through other targets
+#   data=        the DATA files and directories given to AddSIMPLUnitTest
+#   source=      the sources of the test and of every target it links
+#   directory=   the source directories of those targets
+# cmpRunChangedTests.cmake hashes the executable, library, data and source
+# entries to decide if a test has to run again and uses the source and directory
+# entries to find the tests that the current diff affects. Libraries the test
+# only loads at run time are not found here, they have to be given as DATA.
+#
+function(cmpWriteTestManifest TESTNAME)
+    set(pending ${TESTNAME})
+    set(visited "")
+    set(content "name=${TESTNAME}\nexecutable=$<TARGET_FILE:${TESTNAME}>\n")
+    while(pending)
+        list(GET pending 0 current)
+        list(REMOVE_AT pending 0)
+        if(NOT TARGET ${current})
+            list(FIND visited "${current}" index)
+            if(index EQUAL -1 AND IS_ABSOLUTE "${current}" AND EXISTS "${current}")
+                list(APPEND visited "${current}")
+                string(APPEND content "library=${current}\n")
+            endif()
+            continue()
+        endif()
+        get_target_property(aliased ${current} ALIASED_TARGET)
+        if(aliased)
+            set(current ${aliased})
+        endif()
+        list(FIND visited ${current} index)
+        if(NOT index EQUAL -1)
+            continue()
+        endif()
+        list(APPEND visited ${current})
+
+        get_target_property(type ${current} TYPE)
+        if(type STREQUAL "SHARED_LIBRARY" OR type STREQUAL "MODULE_LIBRARY")
+            string(APPEND content "library=$<TARGET_FILE:${current}>\n")
+        endif()
+
+        get_target_property(imported ${current} IMPORTED)
+        set(linked "")
+        if(NOT imported)
+            get_target_property(sourceDir ${current} SOURCE_DIR)
+            string(APPEND content "directory=${sourceDir}\n")
+            if(NOT type STREQUAL "INTERFACE_LIBRARY")
+                get_target_property(sources ${current} SOURCES)
+                foreach(source ${sources})
+                    if(NOT source MATCHES "\\$<")
+                        get_filename_component(source "${source}" ABSOLUTE BASE_DIR "${sourceDir}")
+                        string(APPEND content "source=${source}\n")
+                    endif()
+                endforeach()
+                get_target_property(linked ${current} LINK_LIBRARIES)
+            endif()
+        endif()
+        get_target_property(interfaceLinked ${current} INTERFACE_LINK_LIBRARIES)
+        foreach(library ${linked} ${interfaceLinked})
+            if(NOT library MATCHES "\\$<" AND NOT library MATCHES "-NOTFOUND$")
+                list(APPEND pending ${library})
+            endif()
+        endforeach()
+    endwhile()
+
+    # AddSIMPLUnitTest stored absolute paths
+    get_target_property(data ${TESTNAME} CMP_TEST_DATA)
+    foreach(item ${data})
+        string(APPEND content "data=${item}\n")
+    endforeach()
 
+    file(GENERATE OUTPUT "${CMAKE_BINARY_DIR}/TestManifests/${TESTNAME}-$<CONFIG>.manifest" CONTENT "${content}")
 endfunction()
 
 
@@ -40,6 +40,7 @@ set(CMP_INSTALLATION_SUPPORT_SOURCE_DIR ${CMP_SOURCE_DIR}/InstallationSupport CA
 set(CMP_MODULES_SOURCE_DIR ${CMP_SOURCE_DIR}/Modules CACHE INTERNAL "")
 set(CMP_OSX_TOOLS_SOURCE_DIR ${CMP_SOURCE_DIR}/OSX_Tools CACHE INTERNAL "")
 set(CMP_LINUX_TOOLS_SOURCE_DIR ${CMP_SOURCE_DIR}/Linux_Tools CACHE INTERNAL "")
+set(CMP_TESTING_SOURCE_DIR ${CMP_SOURCE_DIR}/Testing CACHE INTERNAL "")
 
 # --------------------------------------------------------------------
 # Over ride CMake's built in module directory by prepending cmp's module
@@ -49,6 +50,7 @@ set(CMAKE_MODULE_PATH ${CMP_MODULES_SOURCE_DIR} ${CMAKE_MODULE_PATH})
 INCLUDE(${CMP_SOURCE_DIR}/cmpCMakeMacros.cmake )
 
 include( ${CMP_CORE_TESTS_SOURCE_DIR}/cmpConfigureChecks.cmake )
+include( ${CMP_CORE_TESTS_SOURCE_DIR}/cmpMachineCalibration.cmake )
 if(NOT DEFINED CMP_PROJECT_NAMESPACE)
     set(CMP_PROJECT_NAMESPACE "CMP")
 endif()
@@ -65,6 +67,26 @@ if(NOT DEFINED CMP_TYPES_FILE_NAME)
     set(CMP_TYPES_FILE_NAME "cmpTypes.h")
 endif()
 
+if(NOT DEFINED CMP_BYTESWAP_FILE_NAME)
+    set(CMP_BYTESWAP_FILE_NAME "cmpByteSwap.h")
+endif()
+
+if(NOT DEFINED CMP_LATENCY_HISTOGRAM_FILE_NAME)
+    set(CMP_LATENCY_HISTOGRAM_FILE_NAME "cmpLatencyHistogram.h")
+endif()
+
+if(NOT DEFINED CMP_TRACE_FILE_NAME)
+    set(CMP_TRACE_FILE_NAME "cmpTrace.h")
+endif()
+
+if(NOT DEFINED CMP_METRICS_FILE_NAME)
+    set(CMP_METRICS_FILE_NAME "cmpMetrics.h")
+endif()
+
+if(NOT DEFINED CMP_PARALLEL_FILE_NAME)
+    set(CMP_PARALLEL_FILE_NAME "cmpParallel.h")
+endif()
+
 if(NOT DEFINED CMP_VERSION_HEADER_FILE_NAME)
     set(CMP_VERSION_HEADER_FILE_NAME "cmpVersion.h")
 endif()
@@ -95,6 +117,11 @@ endif()
 
 get_filename_component(CMP_CONFIGURATION_HEADER_GUARD ${CMP_CONFIGURATION_FILE_NAME} NAME_WE)
 get_filename_component(CMP_TYPES_HEADER_GUARD ${CMP_TYPES_FILE_NAME} NAME_WE)
+get_filename_component(CMP_BYTESWAP_HEADER_GUARD ${CMP_BYTESWAP_FILE_NAME} NAME_WE)
+get_filename_component(CMP_LATENCY_HISTOGRAM_HEADER_GUARD ${CMP_LATENCY_HISTOGRAM_FILE_NAME} NAME_WE)
+get_filename_component(CMP_TRACE_HEADER_GUARD ${CMP_TRACE_FILE_NAME} NAME_WE)
+get_filename_component(CMP_METRICS_HEADER_GUARD ${CMP_METRICS_FILE_NAME} NAME_WE)
+get_filename_component(CMP_PARALLEL_HEADER_GUARD ${CMP_PARALLEL_FILE_NAME} NAME_WE)
 get_filename_component(CMP_VERSION_HEADER_GUARD ${CMP_VERSION_HEADER_FILE_NAME} NAME_WE)
 
 # --------------------------------------------------------------------
@@ -104,6 +131,24 @@ cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH ${CMP_CONFIGURED_FILES_SOU
                             GENERATED_FILE_PATH ${CMP_HEADER_DIR}/${CMP_CONFIGURATION_FILE_NAME} )
 cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH ${CMP_CONFIGURED_FILES_SOURCE_DIR}/cmpPrimitiveTypes.h.in
                              GENERATED_FILE_PATH ${CMP_HEADER_DIR}/${CMP_TYPES_FILE_NAME} )
+cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH ${CMP_CONFIGURED_FILES_SOURCE_DIR}/cmpByteSwap.h.in
+                             GENERATED_FILE_PATH ${CMP_HEADER_DIR}/${CMP_BYTESWAP_FILE_NAME} )
+cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH ${CMP_CONFIGURED_FILES_SOURCE_DIR}/cmpLatencyHistogram.h.in
+                             GENERATED_FILE_PATH ${CMP_HEADER_DIR}/${CMP_LATENCY_HISTOGRAM_FILE_NAME} )
+cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH ${CMP_CONFIGURED_FILES_SOURCE_DIR}/cmpMetrics.h.in
+                             GENERATED_FILE_PATH ${CMP_HEADER_DIR}/${CMP_METRICS_FILE_NAME} )
+if(CMAKE_VERSION VERSION_LESS 3.19)
+    cmpConfigureParallelHeader(${CMP_HEADER_DIR}/${CMP_PARALLEL_FILE_NAME})
+else()
+    cmake_language(EVAL CODE "cmake_language(DEFER DIRECTORY [[${CMAKE_SOURCE_DIR}]] CALL cmpConfigureParallelHeader [[${CMP_HEADER_DIR}/${CMP_PARALLEL_FILE_NAME}]])")
+endif()
+
+# --------------------------------------------------------------------
+# The CMP_TRACE_SCOPE trace points of cmpTrace.h. With tracing compiled in they
+# only record once a program is started with "--trace out.json"
+option(CMP_ENABLE_TRACING "Compile the CMP_TRACE_SCOPE trace points into the tests and applications" ON)
+cmpConfigureFileWithMD5Check(CONFIGURED_TEMPLATE_PATH ${CMP_CONFIGURED_FILES_SOURCE_DIR}/cmpTrace.h.in
+                             GENERATED_FILE_PATH ${CMP_HEADER_DIR}/${CMP_TRACE_FILE_NAME} )
 
 
 # --------------------------------------------------------------------
@@ -123,22 +168,81 @@ if( ${CMP_GENERATE_VERSION_STRING} )
 endif()
 
 cmp_IDE_GENERATED_PROPERTIES( "Generated"
-              "${CMP_HEADER_DIR}/${CMP_CONFIGURATION_FILE_NAME}"
+              "${CMP_HEADER_DIR}/${CMP_CONFIGURATION_FILE_NAME};${CMP_HEADER_DIR}/${CMP_BYTESWAP_FILE_NAME};${CMP_HEADER_DIR}/${CMP_LATENCY_HISTOGRAM_FILE_NAME};${CMP_HEADER_DIR}/${CMP_TRACE_FILE_NAME};${CMP_HEADER_DIR}/${CMP_METRICS_FILE_NAME};${CMP_HEADER_DIR}/${CMP_PARALLEL_FILE_NAME}"
               "${CMP_HEADER_DIR}/${CMP_TYPES_FILE_NAME}"
               "${CMP_HEADER_DIR}/${CMP_VERSION_HEADER_FILE_NAME};${CMP_HEADER_DIR}/${CMP_VERSION_SOURCE_FILE_NAME}")
 
+# --------------------------------------------------------------------
+# Linux only: Build with split, compressed debug information and move it out of
+# the installed binaries into a separate symbol directory that is organized by
+# build-id. See cmpSplitDebugInfo() in cmpCMakeMacros.cmake
+option(CMP_SPLIT_DEBUG_INFO "Split the debug information out of the installed Linux binaries" OFF)
+set(CMP_SPLIT_DEBUG_INFO_DIR "${PROJECT_BINARY_DIR}/DebugSymbols" CACHE PATH "Directory that receives the split debug information")
+mark_as_advanced(CMP_SPLIT_DEBUG_INFO_DIR)
+
+# --------------------------------------------------------------------
+# Linux only: A developer profile that keeps relinks short: a faster linker, split
+# DWARF and no relinks of the consumers of a changed shared library. See
+# cmpFastLinkProfile() in cmpCMakeMacros.cmake
+option(CMP_FAST_LINK_PROFILE "Link the CMP targets with mold or lld and time every link" OFF)
+set(CMP_FAST_LINKER "" CACHE STRING "Linker of the CMP_FAST_LINK_PROFILE (mold, lld or gold), empty picks the first one that works")
+set(CMP_LINK_TIMES_FILE "${PROJECT_BINARY_DIR}/LinkTimes.log" CACHE FILEPATH "File the CMP_FAST_LINK_PROFILE appends the link times to")
+mark_as_advanced(CMP_FAST_LINKER CMP_LINK_TIMES_FILE)
+
+# --------------------------------------------------------------------
+# Linux only: Cold starts of the installed applications. CMP_LINUX_RPATH_LAUNCH starts
+# them through the RPATH of the binaries alone instead of a launch script that sets
+# LD_LIBRARY_PATH. CMP_LINUX_PREFETCH_LIST records the libraries an application loads
+# while it starts during the installation and reads them ahead on every start.
+option(CMP_LINUX_RPATH_LAUNCH "Start the installed Linux applications without a launch script" OFF)
+option(CMP_LINUX_PREFETCH_LIST "Record the startup libraries of the Linux applications at install time and prefetch them" OFF)
+set(CMP_PREFETCH_RECORD_ARGS "" CACHE STRING "Arguments the applications are started with to record their prefetch list")
+mark_as_advanced(CMP_PREFETCH_RECORD_ARGS)
+
+# --------------------------------------------------------------------
+# Directory the unit tests write their JUnit XML and JSON reports to, one
+# <test>.xml/.json per test executable. Empty writes no reports.
+set(CMP_TEST_REPORT_DIR "" CACHE PATH "Directory that receives the JUnit XML and JSON reports of the unit tests")
+mark_as_advanced(CMP_TEST_REPORT_DIR)
+
+# --------------------------------------------------------------------
+# Exports the symbols of the unit test executables so the --profile mode of the
+# tests can name their functions. Without it they show up as <test>+0x<offset>.
+option(CMP_UNIT_TEST_PROFILER "Export the symbols of the unit tests for their --profile mode" OFF)
+mark_as_advanced(CMP_UNIT_TEST_PROFILER)
+
+# --------------------------------------------------------------------
+# Directory the TUNE target writes the tuned kernel parameters to, one
+# <Kernel>.cmake per kernel, see cmpConfigureTunedConstants(). Point it into the
+# source tree to keep the constants of a node class under version control.
+set(CMP_TUNING_DIR "${CMAKE_BINARY_DIR}/Tuning" CACHE PATH "Directory that holds the tuned kernel parameters")
+mark_as_advanced(CMP_TUNING_DIR)
+
 # --------------------------------------------------------------------
 # Enable the use of plugins that will get generated as part of the project
 # We are going to write the paths to the plugins into a file and then that
 # file will be used as input to set an actual cmake variable and then
-# passed to the bundle utilities cmake macro.
+# passed to the bundle utilities cmake macro. The files are only written at the
+# end of the configure and only if their contents changed.
 if(CMP_ENABLE_PLUGINS)
 
-  file(WRITE ${CMP_PLUGIN_LIST_FILE} "")
-  file(WRITE ${CMP_PLUGIN_SEARCHDIR_FILE} "${PROJECT_BINARY_DIR}/Bin/Plugins;")
-  file(APPEND ${CMP_PLUGIN_SEARCHDIR_FILE} "${PROJECT_BINARY_DIR}/Bin;")
+  cmpWriteGeneratedFile(FILE_PATH ${CMP_PLUGIN_LIST_FILE} CONTENT "")
+  cmpWriteGeneratedFile(FILE_PATH ${CMP_PLUGIN_SEARCHDIR_FILE} CONTENT "${PROJECT_BINARY_DIR}/Bin/Plugins;${PROJECT_BINARY_DIR}/Bin;")
 
 endif()
 
+# --------------------------------------------------------------------
+# CHECK_RECONFIGURE builds the project, configures it again and fails if a build
+# would then compile or link anything, see cmpCheckReconfigure.cmake.
+if(NOT TARGET CHECK_RECONFIGURE)
+  add_custom_target(CHECK_RECONFIGURE
+    COMMAND ${CMAKE_COMMAND} -DCMP_CHECK_SOURCE_DIR=${CMAKE_SOURCE_DIR} -DCMP_CHECK_BINARY_DIR=${CMAKE_BINARY_DIR}
+            -DCMP_CHECK_HEADER_DIR=${CMP_HEADER_DIR} -P ${CMP_TESTING_SOURCE_DIR}/cmpCheckReconfigure.cmake
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+    USES_TERMINAL
+    COMMENT "Checking that configuring again does not rebuild anything")
+  set_target_properties(CHECK_RECONFIGURE PROPERTIES FOLDER "Test")
+endif()
+
 
 